@@ -0,0 +1,71 @@
+#ifndef AGGREGATOR_H
+#define AGGREGATOR_H
+
+#include "sql_parser.h"
+#include "types.h"
+#include "query_arena.h"
+#include "spill_file.h"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// Частичное состояние одной агрегатной функции
+struct AggregateState {
+    int64_t count = 0;
+    int64_t intSum = 0;
+    double doubleSum = 0.0;
+    std::string min;
+    std::string max;
+};
+
+// Хэш-агрегация с GROUP BY. Частичные агрегаты (например, по чанку)
+// накапливаются в отдельных экземплярах и объединяются через merge.
+// Группы и их ключи размещаются в арене, переданной в конструктор.
+// При нехватке памяти группы со своими состояниями сбрасываются в разделы
+// на диске по хэшу ключа (spill) и затем агрегируются по одному разделу.
+class HashAggregator {
+public:
+    // outputGroupIndex[i] - индекс колонки GROUP BY для i-й неагрегатной колонки результата
+    HashAggregator(const std::vector<SelectColumn>& columns,
+                   const std::vector<ColumnType>& argTypes,
+                   const std::vector<int>& outputGroupIndex,
+                   QueryArena& arena);
+
+    // groupKey - значения колонок GROUP BY, args - аргументы агрегатов (nullptr для COUNT(*))
+    void add(const std::vector<const std::string*>& groupKey,
+             const std::vector<const std::string*>& args);
+    void merge(const HashAggregator& other);
+
+    // Запись групп в разделы по хэшу ключа; после этого агрегатор нужно пересоздать
+    void spill(std::vector<std::unique_ptr<SpillFile>>& partitions) const;
+    // Учет группы, прочитанной из раздела
+    void addSpilled(const std::vector<std::string>& record);
+
+    size_t groupCount() const;
+    // Примерный объем памяти групп
+    size_t memoryUsage() const;
+    // Выдача строк результата, пока consumer возвращает true
+    void finish(bool hasGroupBy, const RowConsumer& consumer) const;
+
+private:
+    using States = std::pmr::vector<AggregateState>;
+
+    void update(AggregateState& state, size_t column, const std::string* value);
+    void combine(AggregateState& target, const AggregateState& source, size_t column) const;
+    States& findGroup(std::string_view key);
+    std::string result(const AggregateState& state, size_t column) const;
+
+    std::vector<SelectColumn> columns;
+    std::vector<ColumnType> argTypes;
+    std::vector<int> outputGroupIndex;
+    QueryArena& arena;
+    // Ключ группы - значения GROUP BY с префиксом длины, интернированные в арене
+    std::pmr::unordered_map<std::string_view, States> groups;
+    std::string keyBuffer;
+    size_t bytes = 0;
+};
+
+#endif
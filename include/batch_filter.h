@@ -0,0 +1,34 @@
+#ifndef BATCH_FILTER_H
+#define BATCH_FILTER_H
+
+#include "predicate.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+using SelectionVector = std::vector<uint32_t>;
+
+// Пакетное вычисление условий WHERE над строками одного чанка.
+// Каждое условие вычисляется по пакету из BATCH_SIZE строк и дает вектор выбора
+// (отсортированные индексы подходящих строк). AND сужает вектор выбора,
+// OR объединяет его с подходящими строками из еще не выбранных.
+class BatchFilter {
+public:
+    static const size_t BATCH_SIZE = 1024;
+
+    // Все колонки условия должны принадлежать одной таблице (строки rows)
+    static SelectionVector filter(const std::vector<std::vector<std::string>>& rows,
+                                  const Predicate& predicate);
+
+private:
+    static void evaluateCondition(const Predicate& leaf,
+                                  const std::vector<std::vector<std::string>>& rows,
+                                  const uint32_t* input, size_t inputSize,
+                                  SelectionVector& output);
+    static void filterNode(const Predicate& node,
+                           const std::vector<std::vector<std::string>>& rows,
+                           const SelectionVector& input,
+                           SelectionVector& output);
+};
+
+#endif
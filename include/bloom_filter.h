@@ -0,0 +1,22 @@
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+// Фильтр Блума по ключам соединения: отсутствие ключа точное,
+// присутствие - с небольшой вероятностью ложного срабатывания (~2%)
+class BloomFilter {
+public:
+    explicit BloomFilter(size_t expectedItems);
+
+    void add(std::string_view key);
+    bool mightContain(std::string_view key) const;
+
+private:
+    std::vector<uint64_t> words;
+    uint64_t mask; // Число бит - степень двойки
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <filesystem>
+#include <unordered_map>
+
+using CSVRows = std::vector<std::vector<std::string>>;
+// Номера колонок, значения которых разбираются при чтении чанка; остальные
+// ячейки строки остаются пустыми. Пустая маска - все колонки
+using ColumnMask = std::vector<bool>;
+
+// Общий для процесса пул разобранных чанков (CSV файлов таблиц).
+// Ключ - (путь к чанку, версия), вытеснение - LRU в пределах бюджета памяти.
+// Чанк хранится с маской разобранных колонок и подходит любому запросу,
+// которому нужно их подмножество; иначе он разбирается заново с объединением масок.
+class BufferPool {
+public:
+    static BufferPool& instance();
+
+    void setCapacity(size_t bytes);
+    size_t getCapacity() const;
+    size_t getUsedBytes() const;
+
+    // Возвращает разобранный чанк из памяти или читает его с диска
+    std::shared_ptr<const CSVRows> getChunk(const std::string& filepath, const ColumnMask& columns = {});
+
+    // Сброс закэшированного чанка; вызывается после завершения записи в файл,
+    // чтобы чтение, начатое во время записи, не вернуло в пул старую версию
+    void invalidate(const std::string& filepath);
+    void clear();
+
+    // Оценка занимаемой памяти (используется и для бюджета памяти запроса)
+    static size_t estimateBytes(const CSVRows& rows);
+    static size_t estimateRowBytes(const std::vector<std::string>& row);
+
+private:
+    struct Entry {
+        std::shared_ptr<const CSVRows> rows;
+        ColumnMask columns;
+        size_t bytes;
+        std::filesystem::file_time_type mtime;
+        uintmax_t fileSize;
+        std::list<std::string>::iterator lruPos;
+    };
+
+    BufferPool() = default;
+
+    static bool covers(const ColumnMask& parsed, const ColumnMask& needed);
+    static ColumnMask unite(const ColumnMask& a, const ColumnMask& b);
+
+    void evict(size_t required);
+    void erase(const std::string& filepath);
+    // Удаление версии чанка, который не закэширован и не читается
+    void pruneVersion(const std::string& filepath);
+
+    // Версия чанка нужна, только пока он читается: чтение, во время которого
+    // версия изменилась, не попадает в пул. Записи о незакэшированных и не
+    // читаемых чанках удаляются, поэтому число версий не растет
+    struct Version {
+        uint64_t value = 0;
+        size_t readers = 0;
+    };
+
+    std::unordered_map<std::string, Entry> entries;
+    std::unordered_map<std::string, Version> versions;
+    std::list<std::string> lru; // Начало списка - самый недавно использованный чанк
+    size_t capacity = 64 * 1024 * 1024;
+    size_t usedBytes = 0;
+    mutable std::mutex mutex;
+};
+
+#endif
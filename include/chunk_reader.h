@@ -0,0 +1,39 @@
+#ifndef CHUNK_READER_H
+#define CHUNK_READER_H
+
+#include "buffer_pool.h"
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Последовательное чтение чанков таблицы с упреждением: пока вызывающий поток
+// обрабатывает чанк N, рабочие потоки читают и разбирают следующие чанки.
+// Одновременно в работе не более depth чанков, что ограничивает расход памяти.
+class ChunkReader {
+public:
+    // columns - маска колонок, которые нужно разобрать (пустая - все)
+    ChunkReader(std::vector<std::string> files, size_t depth, ColumnMask columns = {});
+    ~ChunkReader();
+
+    ChunkReader(const ChunkReader&) = delete;
+    ChunkReader& operator=(const ChunkReader&) = delete;
+
+    // Следующий чанк; false, если чанки закончились
+    bool next(std::shared_ptr<const CSVRows>& rows);
+    // Путь к последнему возвращенному чанку
+    const std::string& currentFile() const;
+
+private:
+    void schedule();
+
+    std::vector<std::string> files;
+    size_t depth;
+    ColumnMask columns;
+    size_t scheduled = 0; // Следующий файл для чтения с упреждением
+    size_t current = 0;   // Следующий файл для выдачи
+    std::deque<std::future<std::shared_ptr<const CSVRows>>> pending;
+};
+
+#endif
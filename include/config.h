@@ -4,13 +4,51 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <cstdint>
+#include "types.h"
+
+// Когда INSERT считается завершенным:
+// NONE - строки остаются в буфере таблицы и записываются группой по истечении окна
+//        group_commit_ms (фоновым потоком между запросами), перед чтением или изменением
+//        таблицы и при закрытии базы (сбой процесса теряет группу);
+// FLUSH - строка передана ОС (переживает сбой процесса, но не отключение питания);
+// FSYNC - строка записана на диск (fdatasync на каждый commit).
+// При FLUSH и FSYNC одновременные INSERT из разных потоков ждут общую группу
+// не дольше group_commit_ms
+enum class Durability {
+    NONE,
+    FLUSH,
+    FSYNC
+};
 
 struct DatabaseConfig {
     std::string name;
     int tuples_limit;
+    size_t buffer_pool_size; // Бюджет памяти пула чанков в байтах
+    size_t read_ahead;       // Число чанков, читаемых с упреждением при сканировании (0 - выключено)
+    long long pk_cache_size; // Сколько первичных ключей резервируется за одну запись последовательности
+    size_t query_memory_limit; // Память промежуточных результатов запроса в байтах (0 - без ограничения)
+    Durability durability;     // Гарантия сохранности вставленных строк
+    size_t group_commit_ms;    // Окно накопления группы строк
     std::map<std::string, std::vector<std::string>> structure;
+    std::map<std::string, std::map<std::string, ColumnType>> columnTypes; // Только типизированные колонки
+    
+    // Тип колонки; первичный ключ - int64, колонки без типа - string
+    ColumnType getColumnType(const std::string& tableName, const std::string& columnName) const;
     
+    // "none", "flush" или "fsync"
+    static Durability parseDurability(const std::string& value);
+    
+    // Читает бинарный каталог <filename>.catalog, если он записан для текущих
+    // mtime и размера schema.json, иначе разбирает JSON и обновляет каталог
     static DatabaseConfig loadFromFile(const std::string& filename);
+    
+private:
+    static DatabaseConfig parseJSON(const std::string& content);
+    static bool loadCatalog(const std::string& catalogPath, uint64_t sourceTime, uint64_t sourceSize,
+                            DatabaseConfig& config);
+    static void saveCatalog(const std::string& catalogPath, uint64_t sourceTime, uint64_t sourceSize,
+                            const DatabaseConfig& config);
 };
 
 #endif
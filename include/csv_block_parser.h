@@ -0,0 +1,33 @@
+#ifndef CSV_BLOCK_PARSER_H
+#define CSV_BLOCK_PARSER_H
+
+#include "buffer_pool.h"
+#include "types.h"
+#include <string>
+#include <vector>
+
+// Разбор больших объемов CSV (COPY FROM). Блок текста делится по границам
+// строк на части, которые разбираются и проверяются параллельно в пуле потоков.
+class CSVBlockParser {
+public:
+    // columns/types - колонки, сохраняемые в таблицу; skipLeading - сколько первых
+    // полей строки файла отбрасывается; reserved - пустые ячейки в начале каждой строки (под PK)
+    CSVBlockParser(std::vector<std::string> columns, std::vector<ColumnType> types,
+                   size_t skipLeading, size_t reserved);
+
+    // [begin, end) должен заканчиваться концом строки или концом файла
+    CSVRows parse(const char* begin, const char* end) const;
+
+    // Разбиение строки заголовка на имена колонок
+    static std::vector<std::string> splitLine(const std::string& line);
+
+private:
+    CSVRows parseRange(const char* begin, const char* end) const;
+
+    std::vector<std::string> columns;
+    std::vector<ColumnType> types;
+    size_t skipLeading;
+    size_t reserved;
+};
+
+#endif
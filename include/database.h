@@ -4,32 +4,115 @@
 #include "config.h"
 #include "sql_parser.h"
 #include "file_manager.h"
+#include "statistics.h"
+#include "pk_sequence.h"
+#include "table_writer.h"
+#include "result_set.h"
+#include "spill_file.h"
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
 
 class Database {
 private:
     DatabaseConfig config;
     std::string schemaName;
     
-    bool evaluateCondition(const Condition& cond, 
-                          const std::map<std::string, std::vector<std::string>>& rowData,
-                          const std::map<std::string, std::vector<std::string>>& tableHeaders);
+    // Статистика таблиц для планировщика; изменения сохраняются в flushStatistics,
+    // а снятие флагов упорядоченности - сразу (saveStatistics)
+    std::map<std::string, TableStats> statsCache;
+    std::set<std::string> dirtyStats;
     
-    bool evaluateConditions(const std::vector<Condition>& conditions,
-                           const std::map<std::string, std::vector<std::string>>& rowData,
-                           const std::map<std::string, std::vector<std::string>>& tableHeaders);
+    // Таблицы, уже проверенные или созданные на диске в этом процессе
+    std::set<std::string> openedTables;
+    
+    // Путь к таблице; при первом обращении создает ее файлы
+    std::string openTable(const std::string& tableName);
+    
+    // Последовательности первичных ключей, создаются при первой вставке в таблицу
+    std::map<std::string, std::unique_ptr<PKSequence>> pkSequences;
+    std::mutex pkSequencesMutex;
+    
+    PKSequence& getPKSequence(const std::string& tableName);
+    
+    // Дескрипторы дозаписи, создаются при первой вставке в таблицу
+    std::map<std::string, std::unique_ptr<TableWriter>> tableWriters;
+    
+    TableWriter& getTableWriter(const std::string& tableName, const std::string& tablePath);
+    // Запись накопленной группы строк перед чтением или изменением таблицы;
+    // без tableLocked таблица блокируется на время записи
+    void commitPendingRows(const std::string& tableName, bool tableLocked);
+    void commitAllPendingRows();
+    
+    // Запросы выполняются по одному под statementMutex, поэтому блокировки
+    // таблиц этого процесса не пересекаются. activeStatements - запросы в execute
+    // (и ждущие очереди), groupWaiters - из них INSERT, ждущие записи своей группы
+    std::mutex statementMutex;
+    std::atomic<size_t> activeStatements{0};
+    size_t groupWaiters = 0;
+    std::condition_variable groupCommitted;
+    
+    // Ожидание записи группы со строкой INSERT при flush и fsync (statementMutex отпускается)
+    void waitForGroup(const std::string& tableName, const TableWriter::GroupRow& row,
+                      std::unique_lock<std::mutex>& statement);
+    
+    // Фоновая запись групп при durability = none по истечении окна group_commit_ms
+    // (поток работает между запросами)
+    std::condition_variable groupCommitWake;
+    std::thread groupCommitThread;
+    bool stopGroupCommit = false;
+    
+    void groupCommitLoop();
+    
+    TableStats& getTableStats(const std::string& tableName);
+    void flushStatistics();
+    // Немедленное сохранение статистики таблицы (снятые флаги упорядоченности)
+    void saveStatistics(const std::string& tableName);
     
     std::vector<std::string> getTableHeader(const std::string& tablePath, const std::string& tableName);
+    std::vector<ColumnType> getTableTypes(const std::string& tableName, const std::vector<std::string>& header);
+    ColumnType getOutputType(const SelectColumn& column);
+    
+    long long copyFrom(const CopyQuery& query);
+    long long copyTo(const CopyQuery& query);
+    // Учет загруженных строк в статистике таблицы
+    void addLoadedRows(const std::string& tableName, long long count);
+    
+    // Проверка операторов и литералов условий на соответствие типам колонок
+    void validateConditions(const std::vector<Condition>& conditions);
+    
+    // Выполнение разобранных запросов; вызываются из execute под statementMutex
+    void executeSelect(const SelectQuery& query, const RowConsumer& consumer);
+    std::vector<std::vector<std::string>> executeSelect(const SelectQuery& query);
+    void executeInsert(const InsertQuery& query, std::unique_lock<std::mutex>& statement);
+    // DELETE и UPDATE возвращают число затронутых строк
+    long long executeDelete(const DeleteQuery& query);
+    long long executeUpdate(const UpdateQuery& query);
+    void executeAnalyze(const AnalyzeQuery& query);
+    // Возвращает число загруженных или выгруженных строк
+    long long executeCopy(const CopyQuery& query);
+    void executeSet(const SetQuery& query);
     
 public:
     Database(const DatabaseConfig& config);
+    ~Database();
     
     void initialize();
-    std::vector<std::vector<std::string>> executeSelect(const SelectQuery& query);
-    void executeInsert(const InsertQuery& query);
-    void executeDelete(const DeleteQuery& query);
+    
+    // Разбор и выполнение SQL запроса любого поддерживаемого типа. Запросы из
+    // разных потоков выполняются по очереди; INSERT при durability = flush и fsync
+    // возвращается после записи своей группы строк
+    ResultSet execute(const std::string& sql);
+    // Строки SELECT передаются в onRow по мере готовности (ResultSet содержит
+    // только колонки и число строк), что не требует памяти под весь результат.
+    // onRow вызывается в потоке, вызвавшем execute
+    ResultSet execute(const std::string& sql, const RowConsumer& onRow);
 };
 
 #endif
@@ -0,0 +1,18 @@
+#ifndef DBMS_H
+#define DBMS_H
+
+// Публичный интерфейс библиотеки libdbms для встраивания в приложения:
+//
+//     DatabaseConfig config = DatabaseConfig::loadFromFile("schema.json");
+//     Database db(config);
+//     db.initialize();
+//     ResultSet result = db.execute("SELECT t.a, t.b FROM t");
+//     for (size_t i = 0; i < result.rowCount(); ++i) {
+//         int64_t b = result.getInt64(i, 1);
+//     }
+
+#include "config.h"
+#include "database.h"
+#include "result_set.h"
+
+#endif
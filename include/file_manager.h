@@ -1,26 +1,43 @@
 #ifndef FILE_MANAGER_H
 #define FILE_MANAGER_H
 
+#include "buffer_pool.h"
 #include <string>
 #include <vector>
 #include <fstream>
 #include <map>
+#include <memory>
 
 class FileManager {
 public:
-    static void initializeDatabase(const std::string& schemaName, 
-                                   const std::map<std::string, std::vector<std::string>>& structure);
+    static void initializeDatabase(const std::string& schemaName);
+    // Создание директории таблицы, первого чанка и последовательности PK, если их нет
+    static void initializeTable(const std::string& tablePath, const std::string& tableName,
+                                const std::vector<std::string>& columns);
     
     static std::string getTablePath(const std::string& schemaName, const std::string& tableName);
     static std::vector<std::string> getCSVFiles(const std::string& tablePath);
     static int getNextFileNumber(const std::string& tablePath);
     
-    static std::vector<std::vector<std::string>> readCSVFile(const std::string& filepath);
+    // Разбираются только колонки из маски (пустая маска - все); ширина строки сохраняется
+    static std::vector<std::vector<std::string>> readCSVFile(const std::string& filepath,
+                                                             const ColumnMask& columns = {});
+    // Чтение чанка через общий пул буферов
+    static std::shared_ptr<const std::vector<std::vector<std::string>>> readChunk(const std::string& filepath,
+                                                                              const ColumnMask& columns = {});
+    // Атомарная замена чанка через временный файл с fsync файла и директории
     static void writeCSVFile(const std::string& filepath, 
                             const std::vector<std::string>& header,
                             const std::vector<std::vector<std::string>>& rows);
+    // Запись строк по указателям (без копирования строк чанка)
+    static void writeCSVFile(const std::string& filepath, 
+                            const std::vector<std::string>& header,
+                            const std::vector<const std::vector<std::string>*>& rows);
     static void appendToCSVFile(const std::string& filepath, 
                                const std::vector<std::string>& row);
+    // Добавление нескольких строк за одно открытие файла
+    static void appendToCSVFile(const std::string& filepath, 
+                               const std::vector<std::vector<std::string>>& rows);
     
     static int getRowCount(const std::string& filepath);
     
@@ -28,8 +45,11 @@ public:
     static void unlockTable(const std::string& tablePath, const std::string& tableName);
     static bool isTableLocked(const std::string& tablePath, const std::string& tableName);
     
-    static int readPKSequence(const std::string& tablePath, const std::string& tableName);
-    static void writePKSequence(const std::string& tablePath, const std::string& tableName, int pk);
+    // Верхняя граница зарезервированных первичных ключей (см. PKSequence)
+    static std::string getPKSequencePath(const std::string& tablePath, const std::string& tableName);
+    static long long readPKSequence(const std::string& tablePath, const std::string& tableName);
+    // Запись на диск с fsync и атомарной заменой файла
+    static void writePKSequence(const std::string& tablePath, const std::string& tableName, long long pk);
 };
 
 #endif
@@ -0,0 +1,39 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include <atomic>
+#include <cstddef>
+
+// Бюджет памяти одного запроса (query_memory_limit). Операторы учитывают
+// в нем свои промежуточные данные и, превысив его, сбрасывают их на диск.
+class MemoryBudget {
+public:
+    explicit MemoryBudget(size_t limit); // 0 - без ограничения
+
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    void reserve(size_t bytes);
+    void release(size_t bytes);
+
+    bool exceeded() const;
+    size_t used() const;
+    size_t limit() const;
+
+    // Бюджет общий для операторов запроса, и сторона соединения, построенная
+    // частями, держит его превышенным. Поэтому оператор сбрасывает на диск не
+    // меньше minimumSpill() байт за раз (свою долю бюджета), иначе каждая
+    // строка становилась бы отдельным временным файлом
+    bool shouldSpill(size_t ownBytes) const;
+    size_t minimumSpill() const;
+    // Буфер одного временного файла: при слиянии открыто до MAX_MERGE_FANIN файлов
+    size_t spillBufferSize() const;
+
+    static const size_t MAX_MERGE_FANIN = 64;
+
+private:
+    size_t limitBytes;
+    std::atomic<size_t> usedBytes{0};
+};
+
+#endif
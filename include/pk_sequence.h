@@ -0,0 +1,47 @@
+#ifndef PK_SEQUENCE_H
+#define PK_SEQUENCE_H
+
+#include <mutex>
+#include <string>
+
+// Последовательность первичных ключей таблицы с кэшированием диапазонов.
+// При исчерпании диапазона резервируется следующий блок из cacheSize ключей,
+// и в файл <table>_pk_sequence записывается только его верхняя граница.
+// После перезапуска нумерация продолжается с границы + 1, неиспользованные
+// ключи блока пропускаются.
+//
+// allocate вызывается под блокировкой таблицы и сверяет границу в файле с
+// границей своего блока: если другой процесс зарезервировал ключи после нас,
+// остаток блока отбрасывается. Поэтому ключи в порядке записи строк в чанки
+// возрастают и при вставке из нескольких процессов. Файл границы заменяется
+// только переименованием, поэтому он перечитывается, лишь когда stat находит
+// под его именем другой inode, чем у последней прочитанной или записанной версии.
+class PKSequence {
+public:
+    PKSequence(std::string tablePath, std::string tableName, long long cacheSize);
+    ~PKSequence();
+
+    PKSequence(const PKSequence&) = delete;
+    PKSequence& operator=(const PKSequence&) = delete;
+
+    // Первый из count подряд идущих ключей
+    long long allocate(long long count = 1);
+
+private:
+    // Открытие текущей версии файла границы и чтение границы из нее (0 - файла нет)
+    long long watchFile();
+    // Под именем файла - не та версия, что открыта в watchFile
+    bool fileReplaced() const;
+
+    std::string tablePath;
+    std::string tableName;
+    std::string path;
+    long long cacheSize;
+
+    long long next;  // Следующий свободный ключ
+    long long limit; // Последний зарезервированный ключ (записан в файл)
+    int watchedFd = -1; // Открытая версия удерживает свой inode от повторного использования
+    std::mutex mutex;
+};
+
+#endif
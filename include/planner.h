@@ -0,0 +1,57 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include "predicate.h"
+#include "statistics.h"
+#include <string>
+#include <vector>
+
+// Один уровень конвейера соединений. Первый уровень сканируется потоково
+// (сторона probe), остальные материализуются один раз (сторона build) и,
+// если есть условие равенства с уже выбранными таблицами, хэшируются по ключу.
+// Второй уровень, упорядоченный по ключу так же, как первый, не материализуется:
+// обе таблицы читаются потоково слиянием (merge join).
+struct PlanLevel {
+    int table = -1;          // Индекс таблицы в FROM
+    Predicate scanFilter;    // Условия только по этой таблице, вычисляются при сканировании
+    Predicate joinFilter;    // Условия, вычисляемые сразу после выбора строки этой таблицы
+    ColumnRef probeKey;      // Ключ в уже выбранных таблицах (table = -1 - без хэш-ключа)
+    ColumnRef buildKey;      // Ключ в этой таблице
+    ColumnType keyType = ColumnType::STRING;
+    bool mergeJoin = false;  // Соединение слиянием с первым уровнем вместо хэш-таблицы
+    double estimatedRows = 0; // Строк таблицы после scanFilter
+};
+
+struct QueryPlan {
+    std::vector<PlanLevel> levels;
+};
+
+// Планировщик по статистике таблиц: выбирает порядок соединения, стороны
+// build/probe и переставляет условия по селективности и стоимости.
+class Planner {
+public:
+    // preferredOuter >= 0 фиксирует внешнюю таблицу (например, для ORDER BY по PK с LIMIT)
+    static QueryPlan plan(const Predicate& where,
+                          const std::vector<std::vector<std::string>>& headers,
+                          const std::vector<std::vector<ColumnType>>& types,
+                          const std::vector<TableStats>& stats,
+                          int preferredOuter);
+
+    // Оценка селективности и стоимости с сортировкой детей AND/OR
+    static void estimate(Predicate& node,
+                         const std::vector<std::vector<std::string>>& headers,
+                         const std::vector<TableStats>& stats);
+
+private:
+    static double distinctValues(const ColumnRef& ref,
+                                 const std::vector<std::vector<std::string>>& headers,
+                                 const std::vector<TableStats>& stats);
+    static void addChild(Predicate& target, Predicate child);
+    // Колонка упорядочена по возрастанию в типе ключа: отмечена ANALYZE
+    static bool isOrdered(const ColumnRef& ref, ColumnType keyType,
+                          const std::vector<std::vector<std::string>>& headers,
+                          const std::vector<std::vector<ColumnType>>& types,
+                          const std::vector<TableStats>& stats);
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef PREDICATE_H
+#define PREDICATE_H
+
+#include "sql_parser.h"
+#include "types.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Кортеж: по одной строке на каждую таблицу из FROM (nullptr - строка еще не выбрана)
+using Tuple = std::vector<const std::vector<std::string>*>;
+
+struct ColumnRef {
+    int table = -1;  // Индекс таблицы в FROM, -1 - колонка не найдена
+    int column = -1; // Индекс колонки в заголовке таблицы
+};
+
+// Значение колонки в кортеже (пустое, если колонки нет)
+const std::string& tupleValue(const Tuple& tuple, const ColumnRef& ref);
+
+// Поиск колонки таблица.колонка среди таблиц FROM
+ColumnRef resolveColumn(const std::string& tableName, const std::string& columnName,
+                        const std::vector<std::string>& tables,
+                        const std::vector<std::vector<std::string>>& headers);
+
+// Дерево условий WHERE. Список условий, объединяемых слева направо
+// (((a AND b) OR c) AND d), превращается в узлы AND/OR с произвольным
+// числом детей; внутри узла дети переставляются планировщиком.
+class Predicate {
+public:
+    enum class Kind {
+        CONDITION,
+        AND,
+        OR
+    };
+
+    Kind kind = Kind::AND;
+    Condition condition;
+    std::vector<Predicate> children;
+
+    // Привязка листа к колонкам
+    ColumnRef left;
+    ColumnRef right;
+    CompareOp op = CompareOp::EQ;
+    ColumnType type = ColumnType::STRING;
+
+    // Оценки планировщика
+    double selectivity = 1.0;
+    double cost = 0.0;
+
+    static Predicate fromConditions(const std::vector<Condition>& conditions);
+    static Predicate leaf(const Condition& condition);
+
+    // Пустой AND - условие всегда истинно
+    bool isTrue() const;
+    // Равенство колонок двух разных таблиц
+    bool isEquiJoin() const;
+    // Битовая маска таблиц, от которых зависит условие
+    uint64_t tableMask() const;
+
+    void bind(const std::vector<std::string>& tables,
+              const std::vector<std::vector<std::string>>& headers,
+              const std::vector<std::vector<ColumnType>>& types);
+
+    // Вычисление с сокращенной схемой: AND до первого ложного, OR до первого истинного
+    bool evaluate(const Tuple& tuple) const;
+    bool evaluateLeaf(const std::string& leftValue, const std::string& rightValue) const;
+};
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef QUERY_ARENA_H
+#define QUERY_ARENA_H
+
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+// Память одного запроса: хэш-таблицы соединений, группы агрегации и
+// интернированные ключи выделяются последовательно и освобождаются разом
+// при уничтожении арены. Строки чанков живут в пуле буферов и сюда не входят.
+class QueryArena {
+public:
+    QueryArena();
+
+    QueryArena(const QueryArena&) = delete;
+    QueryArena& operator=(const QueryArena&) = delete;
+
+    std::pmr::memory_resource* resource();
+
+    // Одинаковые значения хранятся в арене один раз; представление
+    // действительно до конца жизни арены
+    std::string_view intern(std::string_view value);
+
+private:
+    std::pmr::monotonic_buffer_resource memory;
+    std::pmr::unordered_set<std::string_view> strings;
+};
+
+#endif
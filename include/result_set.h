@@ -0,0 +1,101 @@
+#ifndef RESULT_SET_H
+#define RESULT_SET_H
+
+#include "sql_parser.h"
+#include "types.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+using ResultRows = std::vector<std::vector<std::string>>;
+
+// Строка результата: значения доступны по ссылке, без копирования
+class RowView {
+public:
+    explicit RowView(const std::vector<std::string>& row) : row(&row) {}
+
+    size_t size() const { return row->size(); }
+    std::string_view operator[](size_t column) const { return (*row)[column]; }
+
+private:
+    const std::vector<std::string>* row;
+};
+
+// Колонка результата: значение column в каждой строке
+class ColumnView {
+public:
+    ColumnView(const ResultRows& rows, size_t column) : rows(&rows), column(column) {}
+
+    size_t size() const { return rows->size(); }
+    std::string_view operator[](size_t row) const { return (*rows)[row][column]; }
+
+private:
+    const ResultRows* rows;
+    size_t column;
+};
+
+// Пакет подряд идущих строк [start, start + size)
+class RowBatch {
+public:
+    RowBatch(const ResultRows& rows, size_t start, size_t count) : rows(&rows), start(start), count(count) {}
+
+    size_t size() const { return count; }
+    size_t firstRow() const { return start; }
+    RowView operator[](size_t index) const { return RowView((*rows)[start + index]); }
+
+private:
+    const ResultRows* rows;
+    size_t start;
+    size_t count;
+};
+
+// Результат Database::execute. Для SELECT содержит строки и описание колонок
+// (affectedRows - число строк), для остальных запросов - число затронутых строк.
+// Пустое значение - NULL.
+class ResultSet {
+public:
+    ResultSet() = default;
+    ResultSet(QueryType type, long long affectedRows);
+    ResultSet(std::vector<std::string> columnNames, std::vector<ColumnType> columnTypes, ResultRows rows);
+    // SELECT, строки которого переданы получателю и не хранятся
+    ResultSet(std::vector<std::string> columnNames, std::vector<ColumnType> columnTypes, long long streamedRows);
+
+    QueryType type() const { return queryType; }
+    long long affectedRows() const { return affected; }
+
+    size_t rowCount() const { return rows.size(); }
+    size_t columnCount() const { return names.size(); }
+    const std::string& columnName(size_t column) const { return names[column]; }
+    ColumnType columnType(size_t column) const { return types[column]; }
+    // Индекс колонки по имени ("таблица.колонка", "COUNT(*)"), -1 - нет такой колонки
+    int findColumn(const std::string& name) const;
+
+    RowView row(size_t index) const { return RowView(rows[index]); }
+    ColumnView column(size_t index) const { return ColumnView(rows, index); }
+    // Пакеты по batchSize строк (последний может быть короче)
+    size_t batchCount(size_t batchSize) const;
+    RowBatch batch(size_t index, size_t batchSize) const;
+
+    bool isNull(size_t row, size_t column) const;
+    std::string_view getString(size_t row, size_t column) const;
+    // Типизированные значения; для NULL и некорректных значений - исключение
+    int64_t getInt64(size_t row, size_t column) const;
+    double getDouble(size_t row, size_t column) const;
+    // Дата как число YYYYMMDD
+    int64_t getDate(size_t row, size_t column) const;
+
+    // Передача строк вызывающему без копирования
+    ResultRows takeRows() { return std::move(rows); }
+
+private:
+    TypedValue typedValue(size_t row, size_t column, ColumnType type) const;
+
+    QueryType queryType = QueryType::UNKNOWN;
+    long long affected = 0;
+    std::vector<std::string> names;
+    std::vector<ColumnType> types;
+    ResultRows rows;
+};
+
+#endif
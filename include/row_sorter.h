@@ -0,0 +1,61 @@
+#ifndef ROW_SORTER_H
+#define ROW_SORTER_H
+
+#include "types.h"
+#include "memory_budget.h"
+#include "spill_file.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct SortKey {
+    size_t index; // Индекс значения в строке
+    ColumnType type;
+    bool descending;
+};
+
+// Сортировка строк для ORDER BY. При заданном пределе хранит только
+// limit лучших строк в куче (top-k). Порядок равных строк сохраняется.
+// Без предела строки сверх бюджета памяти сортируются порциями, порции
+// записываются во временные файлы и сливаются при выдаче (внешняя сортировка).
+// Одновременно сливается не больше MAX_MERGE_FANIN порций: порции одного уровня
+// сливаются в порцию следующего уровня по мере накопления, а при выдаче
+// остаток сливается в несколько проходов.
+class RowSorter {
+public:
+    RowSorter(const std::vector<SortKey>& keys, long long limit, MemoryBudget* budget = nullptr);
+    ~RowSorter();
+
+    void add(std::vector<std::string> row);
+    // Выдача строк в порядке сортировки, пока consumer возвращает true
+    void finish(const RowConsumer& consumer);
+    std::vector<std::vector<std::string>> finish();
+
+private:
+    struct Entry {
+        std::vector<std::string> row;
+        uint64_t sequence;
+    };
+
+    bool less(const Entry& a, const Entry& b) const;
+    void spillRun();
+    std::unique_ptr<SpillFile> newRun() const;
+    // Слияние порций [first, last) и, если withMemory, отсортированных строк
+    // в памяти (как последней порции); порядок равных строк - по номеру порции
+    void merge(size_t first, size_t last, bool withMemory, const RowConsumer& consumer);
+    // Слияние порций [first, last) в одну порцию на диске
+    std::unique_ptr<SpillFile> mergeToRun(size_t first, size_t last);
+
+    std::vector<SortKey> keys;
+    long long limit;
+    uint64_t nextSequence = 0;
+    std::vector<Entry> entries; // При limit >= 0 - куча с худшей строкой в вершине
+
+    MemoryBudget* budget;
+    size_t reservedBytes = 0;
+    std::vector<std::unique_ptr<SpillFile>> runs; // Отсортированные порции на диске в порядке поступления строк
+    std::vector<int> runLevels;                   // Сколько раз порция получена слиянием (не возрастает)
+};
+
+#endif
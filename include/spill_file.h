@@ -0,0 +1,40 @@
+#ifndef SPILL_FILE_H
+#define SPILL_FILE_H
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Получатель строк результата; false - строк больше не нужно
+using RowConsumer = std::function<bool(std::vector<std::string>& row)>;
+
+// Временный файл для строк, не поместившихся в бюджет памяти запроса.
+// Формат компактный двоичный: число значений, затем длина и байты каждого значения.
+// Файл удаляется из каталога сразу после создания и исчезает при закрытии
+// (в том числе при аварийном завершении процесса).
+class SpillFile {
+public:
+    explicit SpillFile(size_t bufferSize = DEFAULT_BUFFER_SIZE);
+    ~SpillFile();
+
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    void write(const std::vector<std::string>& row);
+    // Переход от записи к чтению с начала файла
+    void rewind();
+    // Следующая строка; false, если строки закончились
+    bool read(std::vector<std::string>& row);
+
+    size_t rowCount() const;
+
+    static const size_t DEFAULT_BUFFER_SIZE = 1024 * 1024;
+
+private:
+    std::FILE* file = nullptr;
+    size_t rows = 0;
+    std::vector<char> buffer; // Буфер stdio
+};
+
+#endif
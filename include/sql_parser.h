@@ -9,22 +9,43 @@ enum class QueryType {
     SELECT,
     INSERT,
     DELETE,
+    UPDATE,
+    ANALYZE,
+    COPY,
+    SET,
     UNKNOWN
 };
 
+enum class AggregateFunc {
+    NONE,
+    COUNT,
+    SUM,
+    MIN,
+    MAX,
+    AVG
+};
+
 struct SelectColumn {
     std::string tableName;
     std::string columnName;
+    AggregateFunc aggregate = AggregateFunc::NONE;
+    bool isStar = false; // COUNT(*)
+};
+
+struct OrderByColumn {
+    SelectColumn column;
+    bool descending = false;
 };
 
 struct Condition {
     std::string leftTable;
     std::string leftColumn;
-    std::string operator_;
+    std::string operator_; // =, !=, <>, <, <=, >, >=, BETWEEN
     std::string rightTable;
     std::string rightColumn;
     std::string rightValue; // Для литеральных значений
-    bool isLiteral;
+    std::string rightValue2; // Верхняя граница BETWEEN
+    bool isLiteral = false;
     
     std::string logicalOp; // "AND" или "OR"
 };
@@ -33,6 +54,12 @@ struct SelectQuery {
     std::vector<SelectColumn> columns;
     std::vector<std::string> tables;
     std::vector<Condition> conditions;
+    std::vector<SelectColumn> groupBy;
+    std::vector<OrderByColumn> orderBy;
+    long long limit = -1; // -1 - без ограничения
+    long long offset = 0;
+    
+    bool hasAggregates() const;
 };
 
 struct InsertQuery {
@@ -45,18 +72,51 @@ struct DeleteQuery {
     std::vector<Condition> conditions;
 };
 
+struct Assignment {
+    std::string columnName;
+    std::string value;
+};
+
+struct UpdateQuery {
+    std::string tableName;
+    std::vector<Assignment> assignments;
+    std::vector<Condition> conditions;
+};
+
+struct CopyQuery {
+    std::string tableName;
+    std::string filePath;
+    bool toFile = false; // COPY ... TO (выгрузка) или COPY ... FROM (загрузка)
+};
+
+// Настройка сеанса: SET имя = значение
+struct SetQuery {
+    std::string name;
+    std::string value;
+};
+
+struct AnalyzeQuery {
+    std::string tableName; // Пусто - все таблицы схемы
+};
+
 class SQLParser {
 public:
     static QueryType parseQueryType(const std::string& query);
     static SelectQuery parseSelect(const std::string& query);
     static InsertQuery parseInsert(const std::string& query);
     static DeleteQuery parseDelete(const std::string& query);
+    static UpdateQuery parseUpdate(const std::string& query);
+    static AnalyzeQuery parseAnalyze(const std::string& query);
+    static CopyQuery parseCopy(const std::string& query);
+    static SetQuery parseSet(const std::string& query);
     
 private:
     static std::vector<std::string> tokenize(const std::string& query);
     static std::string trim(const std::string& str);
     static std::string removeQuotes(const std::string& str);
     static Condition parseCondition(const std::vector<std::string>& tokens, size_t& pos);
+    static bool parseColumnRef(const std::string& token, SelectColumn& column);
+    static bool parseSelectItem(const std::vector<std::string>& tokens, size_t& pos, SelectColumn& column);
 };
 
 #endif
@@ -0,0 +1,31 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include "types.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+// Статистика таблицы для планировщика
+struct TableStats {
+    long long rowCount = 0;
+    std::map<std::string, long long> distinctCounts; // Число различных значений колонок
+    std::set<std::string> sortedColumns;             // Колонки, упорядоченные по возрастанию в порядке чанков
+    bool analyzed = false; // false - только оценка числа строк по чанкам
+
+    // -1, если для колонки нет статистики
+    long long distinct(const std::string& columnName) const;
+    bool isSorted(const std::string& columnName) const;
+};
+
+// Статистика хранится в файле <table>/<table>_stats и обновляется командой ANALYZE
+class Statistics {
+public:
+    static bool load(const std::string& tablePath, const std::string& tableName, TableStats& stats);
+    static void save(const std::string& tablePath, const std::string& tableName, const TableStats& stats);
+    static TableStats analyze(const std::vector<std::string>& files, const std::vector<std::string>& header,
+                              const std::vector<ColumnType>& types, size_t readAhead);
+};
+
+#endif
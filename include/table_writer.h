@@ -0,0 +1,85 @@
+#ifndef TABLE_WRITER_H
+#define TABLE_WRITER_H
+
+#include "config.h"
+#include "pk_sequence.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+// Долгоживущий дескриптор дозаписи в последний чанк таблицы.
+// Строки накапливаются в буфере и записываются группой (group commit) одним
+// вызовом write на чанк; число строк последнего чанка известно без его чтения.
+// Перед записью проверяется, что чанк не заменен и не дописан другим процессом
+// или UPDATE/DELETE/COPY (тогда чанк открывается заново).
+// Вызывающий должен удерживать блокировку таблицы на время commit.
+class TableWriter {
+public:
+    // Группа строк, записываемых одним commit (при fsync - с одним fdatasync)
+    struct Group {
+        bool done = false;     // Группа записана или отброшена
+        size_t rows = 0;       // Строк добавлено в группу
+        size_t written = 0;    // Из них записано в чанки (первые по порядку)
+        std::string error;     // Причина, по которой остальные строки не записаны
+    };
+    // Место строки в группе: INSERT ждет записи своей строки
+    struct GroupRow {
+        std::shared_ptr<const Group> group;
+        size_t index;
+
+        bool written() const { return index < group->written; }
+    };
+
+    TableWriter(std::string tablePath, std::vector<std::string> header, int tuplesLimit);
+    ~TableWriter();
+
+    TableWriter(const TableWriter&) = delete;
+    TableWriter& operator=(const TableWriter&) = delete;
+
+    const std::vector<std::string>& getHeader() const { return header; }
+
+    // Добавление строки (значения без первичного ключа) в буфер группы;
+    // на диск строка попадает при commit
+    GroupRow append(const std::vector<std::string>& values);
+    size_t pendingRows() const { return pending.size(); }
+    // Первая строка группы ждет дольше window или буфер группы заполнен
+    bool due(std::chrono::milliseconds window) const;
+    // Момент, когда у первой строки группы истекает окно window
+    std::chrono::steady_clock::time_point deadline(std::chrono::milliseconds window) const {
+        return firstPending + window;
+    }
+
+    // Запись группы в чанки с ключами из sequence; при Durability::FSYNC - с fdatasync на чанк.
+    // При ошибке недописанный блок обрезается; при NONE незаписанные строки
+    // остаются в буфере до следующего commit, иначе группа отбрасывается
+    void commit(Durability durability, PKSequence& sequence);
+    // Завершение группы без записи оставшихся строк
+    void abandon(const std::string& error);
+
+private:
+    void openTail();
+    // Новый чанк с заголовком; если файл уже есть, открывается последний чанк таблицы
+    void createChunk(int number, Durability durability);
+    std::string formatHeader() const;
+    bool tailChanged() const;
+    void closeTail();
+
+    std::string tablePath;
+    std::vector<std::string> header;
+    int tuplesLimit;
+
+    std::string tailPath;
+    int tailNumber = 0;
+    int tailRows = 0;
+    off_t tailSize = 0; // Ожидаемый размер чанка после наших записей
+    int fd = -1;
+
+    std::vector<std::string> pending; // Значения строк группы в формате CSV (",v1,v2\n"), ключ - при commit
+    size_t pendingBytes = 0;
+    std::chrono::steady_clock::time_point firstPending;
+    std::shared_ptr<Group> group = std::make_shared<Group>();
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef TYPES_H
+#define TYPES_H
+
+#include <string>
+#include <cstdint>
+
+enum class ColumnType {
+    STRING,
+    INT64,
+    DOUBLE,
+    DATE
+};
+
+enum class CompareOp {
+    EQ,
+    NE,
+    LT,
+    LE,
+    GT,
+    GE,
+    BETWEEN,
+    INVALID
+};
+
+// Значение ячейки, приведенное к типу колонки
+struct TypedValue {
+    bool valid;
+    int64_t intValue;  // INT64 и DATE (YYYYMMDD)
+    double doubleValue;
+    const std::string* text;
+};
+
+class ColumnTypes {
+public:
+    static ColumnType parseType(const std::string& name);
+    static std::string typeName(ColumnType type);
+    static CompareOp parseOperator(const std::string& op);
+
+    static TypedValue convert(const std::string& value, ColumnType type);
+    // Пустая строка допустима для любого типа
+    static bool isValid(const std::string& value, ColumnType type);
+
+    // Сравнение в типе колонки: <0, 0, >0. Некорректные значения меньше корректных
+    // (порядок для ORDER BY и слияния; условия WHERE их не пропускают, см. evaluate)
+    static int compare(const TypedValue& a, const TypedValue& b, ColumnType type);
+    static int compare(const std::string& a, const std::string& b, ColumnType type);
+
+    // Кратчайшая запись double без потери точности
+    static std::string formatDouble(double value);
+
+    static bool test(CompareOp op, int cmp);
+    // Условие сравнения; пустое или некорректное значение (как NULL) не
+    // удовлетворяет никакому сравнению, в том числе != - так же его пропускают агрегаты
+    static bool evaluate(CompareOp op, const TypedValue& value,
+                         const TypedValue& right, const TypedValue& upper, ColumnType type);
+};
+
+#endif
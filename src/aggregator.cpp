@@ -0,0 +1,260 @@
+#include "aggregator.h"
+#include <cstring>
+#include <functional>
+
+// Примерные накладные расходы хэш-таблицы на одну группу
+static const size_t GROUP_OVERHEAD = 64;
+
+HashAggregator::HashAggregator(const std::vector<SelectColumn>& columns,
+                               const std::vector<ColumnType>& argTypes,
+                               const std::vector<int>& outputGroupIndex,
+                               QueryArena& arena)
+    : columns(columns), argTypes(argTypes), outputGroupIndex(outputGroupIndex),
+      arena(arena), groups(arena.resource()) {
+}
+
+// Разбор ключа группы обратно в значения колонок GROUP BY
+static std::vector<std::string> decodeKey(std::string_view key) {
+    std::vector<std::string> values;
+    size_t pos = 0;
+    while (pos + sizeof(uint32_t) <= key.size()) {
+        uint32_t length;
+        std::memcpy(&length, key.data() + pos, sizeof(length));
+        pos += sizeof(length);
+        values.emplace_back(key.substr(pos, length));
+        pos += length;
+    }
+    return values;
+}
+
+// Числовое значение аргумента SUM/AVG; нечисловые значения пропускаются
+static bool numericValue(const std::string& value, ColumnType type, int64_t& intValue, double& doubleValue) {
+    TypedValue typed = ColumnTypes::convert(value, type == ColumnType::INT64 ? type : ColumnType::DOUBLE);
+    intValue = typed.intValue;
+    doubleValue = typed.doubleValue;
+    return typed.valid;
+}
+
+void HashAggregator::update(AggregateState& state, size_t column, const std::string* value) {
+    AggregateFunc func = columns[column].aggregate;
+
+    if (value == nullptr) {
+        state.count++; // COUNT(*)
+        return;
+    }
+    if (value->empty()) {
+        return; // Пустое значение не учитывается, как NULL
+    }
+
+    switch (func) {
+        case AggregateFunc::COUNT:
+            state.count++;
+            break;
+        case AggregateFunc::SUM:
+        case AggregateFunc::AVG: {
+            int64_t intValue;
+            double doubleValue;
+            if (numericValue(*value, argTypes[column], intValue, doubleValue)) {
+                state.count++;
+                if (argTypes[column] == ColumnType::INT64) {
+                    state.intSum += intValue;
+                } else {
+                    state.doubleSum += doubleValue;
+                }
+            }
+            break;
+        }
+        case AggregateFunc::MIN:
+            if (state.count == 0 || ColumnTypes::compare(*value, state.min, argTypes[column]) < 0) {
+                state.min = *value;
+            }
+            state.count++;
+            break;
+        case AggregateFunc::MAX:
+            if (state.count == 0 || ColumnTypes::compare(*value, state.max, argTypes[column]) > 0) {
+                state.max = *value;
+            }
+            state.count++;
+            break;
+        default:
+            break;
+    }
+}
+
+void HashAggregator::add(const std::vector<const std::string*>& groupKey,
+                         const std::vector<const std::string*>& args) {
+    // Ключ группы: значения с префиксом длины
+    keyBuffer.clear();
+    for (const std::string* value : groupKey) {
+        uint32_t length = static_cast<uint32_t>(value->size());
+        keyBuffer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        keyBuffer.append(*value);
+    }
+
+    States& states = findGroup(keyBuffer);
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (columns[i].aggregate != AggregateFunc::NONE) {
+            update(states[i], i, args[i]);
+        }
+    }
+}
+
+HashAggregator::States& HashAggregator::findGroup(std::string_view key) {
+    auto it = groups.find(key);
+    if (it == groups.end()) {
+        it = groups.emplace(arena.intern(key), States(columns.size(), arena.resource())).first;
+        bytes += key.size() + columns.size() * sizeof(AggregateState) + GROUP_OVERHEAD;
+    }
+    return it->second;
+}
+
+void HashAggregator::combine(AggregateState& target, const AggregateState& source, size_t column) const {
+    if (source.count == 0) {
+        return;
+    }
+
+    AggregateFunc func = columns[column].aggregate;
+    if (func == AggregateFunc::MIN &&
+        (target.count == 0 || ColumnTypes::compare(source.min, target.min, argTypes[column]) < 0)) {
+        target.min = source.min;
+    }
+    if (func == AggregateFunc::MAX &&
+        (target.count == 0 || ColumnTypes::compare(source.max, target.max, argTypes[column]) > 0)) {
+        target.max = source.max;
+    }
+
+    target.count += source.count;
+    target.intSum += source.intSum;
+    target.doubleSum += source.doubleSum;
+}
+
+void HashAggregator::merge(const HashAggregator& other) {
+    for (const auto& [key, otherStates] : other.groups) {
+        auto it = groups.find(key);
+        if (it == groups.end()) {
+            // Ключ переносится в арену этого агрегатора: арена частичного может быть короче
+            groups.emplace(arena.intern(key), States(otherStates.begin(), otherStates.end(), arena.resource()));
+            bytes += key.size() + columns.size() * sizeof(AggregateState) + GROUP_OVERHEAD;
+            continue;
+        }
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (columns[i].aggregate != AggregateFunc::NONE) {
+                combine(it->second[i], otherStates[i], i);
+            }
+        }
+    }
+}
+
+// Состояние агрегата в записи раздела: count, intSum, doubleSum, затем min и max с длиной
+static void encodeState(const AggregateState& state, std::string& out) {
+    out.append(reinterpret_cast<const char*>(&state.count), sizeof(state.count));
+    out.append(reinterpret_cast<const char*>(&state.intSum), sizeof(state.intSum));
+    out.append(reinterpret_cast<const char*>(&state.doubleSum), sizeof(state.doubleSum));
+    for (const std::string* value : {&state.min, &state.max}) {
+        uint32_t length = static_cast<uint32_t>(value->size());
+        out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.append(*value);
+    }
+}
+
+static AggregateState decodeState(const std::string& data) {
+    AggregateState state;
+    size_t pos = 0;
+    std::memcpy(&state.count, data.data() + pos, sizeof(state.count));
+    pos += sizeof(state.count);
+    std::memcpy(&state.intSum, data.data() + pos, sizeof(state.intSum));
+    pos += sizeof(state.intSum);
+    std::memcpy(&state.doubleSum, data.data() + pos, sizeof(state.doubleSum));
+    pos += sizeof(state.doubleSum);
+    for (std::string* value : {&state.min, &state.max}) {
+        uint32_t length;
+        std::memcpy(&length, data.data() + pos, sizeof(length));
+        pos += sizeof(length);
+        value->assign(data, pos, length);
+        pos += length;
+    }
+    return state;
+}
+
+void HashAggregator::spill(std::vector<std::unique_ptr<SpillFile>>& partitions) const {
+    // Запись: ключ группы, затем состояния агрегатных колонок
+    std::vector<std::string> record;
+    for (const auto& [key, states] : groups) {
+        record.assign(1, std::string(key));
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (columns[i].aggregate != AggregateFunc::NONE) {
+                record.emplace_back();
+                encodeState(states[i], record.back());
+            }
+        }
+        partitions[std::hash<std::string_view>()(key) % partitions.size()]->write(record);
+    }
+}
+
+void HashAggregator::addSpilled(const std::vector<std::string>& record) {
+    States& states = findGroup(record[0]);
+    size_t field = 1;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (columns[i].aggregate != AggregateFunc::NONE) {
+            combine(states[i], decodeState(record[field++]), i);
+        }
+    }
+}
+
+size_t HashAggregator::groupCount() const {
+    return groups.size();
+}
+
+size_t HashAggregator::memoryUsage() const {
+    return bytes;
+}
+
+std::string HashAggregator::result(const AggregateState& state, size_t column) const {
+    bool isInt = argTypes[column] == ColumnType::INT64;
+
+    switch (columns[column].aggregate) {
+        case AggregateFunc::COUNT:
+            return std::to_string(state.count);
+        case AggregateFunc::SUM:
+            if (state.count == 0) return "";
+            return isInt ? std::to_string(state.intSum) : ColumnTypes::formatDouble(state.doubleSum);
+        case AggregateFunc::AVG:
+            if (state.count == 0) return "";
+            return ColumnTypes::formatDouble((isInt ? static_cast<double>(state.intSum) : state.doubleSum) /
+                                             static_cast<double>(state.count));
+        case AggregateFunc::MIN:
+            return state.count == 0 ? "" : state.min;
+        case AggregateFunc::MAX:
+            return state.count == 0 ? "" : state.max;
+        default:
+            return "";
+    }
+}
+
+void HashAggregator::finish(bool hasGroupBy, const RowConsumer& consumer) const {
+    // Без GROUP BY агрегаты по пустому входу дают одну строку
+    if (groups.empty() && !hasGroupBy) {
+        std::vector<std::string> row;
+        AggregateState empty;
+        for (size_t i = 0; i < columns.size(); ++i) {
+            row.push_back(result(empty, i));
+        }
+        consumer(row);
+        return;
+    }
+
+    for (const auto& [key, states] : groups) {
+        std::vector<std::string> keyValues = decodeKey(key);
+        std::vector<std::string> row;
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (columns[i].aggregate == AggregateFunc::NONE) {
+                row.push_back(keyValues[outputGroupIndex[i]]);
+            } else {
+                row.push_back(result(states[i], i));
+            }
+        }
+        if (!consumer(row)) {
+            return;
+        }
+    }
+}
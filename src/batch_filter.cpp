@@ -0,0 +1,141 @@
+#include "batch_filter.h"
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+static const std::string emptyValue;
+
+static inline const std::string& cellAt(const std::vector<std::string>& row, int index) {
+    if (index < 0 || static_cast<size_t>(index) >= row.size()) {
+        return emptyValue;
+    }
+    return row[index];
+}
+
+void BatchFilter::evaluateCondition(const Predicate& leaf,
+                                    const std::vector<std::vector<std::string>>& rows,
+                                    const uint32_t* input, size_t inputSize,
+                                    SelectionVector& output) {
+    uint8_t matches[BATCH_SIZE];
+    const Condition& cond = leaf.condition;
+    int leftIndex = leaf.left.column;
+    ColumnType type = leaf.type;
+    CompareOp op = leaf.op;
+    bool plainEquality = op == CompareOp::EQ && type == ColumnType::STRING;
+
+    if (cond.isLiteral) {
+        const std::string& value = cond.rightValue;
+        if (plainEquality) {
+            for (size_t i = 0; i < inputSize; ++i) {
+                matches[i] = cellAt(rows[input[i]], leftIndex) == value;
+            }
+        } else {
+            // Литералы приводятся к типу колонки один раз на пакет
+            TypedValue right = ColumnTypes::convert(value, type);
+            TypedValue upper = ColumnTypes::convert(cond.rightValue2, type);
+            for (size_t i = 0; i < inputSize; ++i) {
+                TypedValue cell = ColumnTypes::convert(cellAt(rows[input[i]], leftIndex), type);
+                matches[i] = ColumnTypes::evaluate(op, cell, right, upper, type);
+            }
+        }
+    } else {
+        int rightIndex = leaf.right.column;
+        if (plainEquality) {
+            for (size_t i = 0; i < inputSize; ++i) {
+                const auto& row = rows[input[i]];
+                matches[i] = cellAt(row, leftIndex) == cellAt(row, rightIndex);
+            }
+        } else {
+            for (size_t i = 0; i < inputSize; ++i) {
+                const auto& row = rows[input[i]];
+                TypedValue left = ColumnTypes::convert(cellAt(row, leftIndex), type);
+                TypedValue right = ColumnTypes::convert(cellAt(row, rightIndex), type);
+                matches[i] = ColumnTypes::evaluate(op, left, right, right, type);
+            }
+        }
+    }
+
+    // Сжатие вектора выбора без ветвлений
+    output.resize(inputSize);
+    size_t count = 0;
+    for (size_t i = 0; i < inputSize; ++i) {
+        output[count] = input[i];
+        count += matches[i];
+    }
+    output.resize(count);
+}
+
+void BatchFilter::filterNode(const Predicate& node,
+                             const std::vector<std::vector<std::string>>& rows,
+                             const SelectionVector& input,
+                             SelectionVector& output) {
+    switch (node.kind) {
+        case Predicate::Kind::CONDITION:
+            evaluateCondition(node, rows, input.data(), input.size(), output);
+            return;
+
+        case Predicate::Kind::AND: {
+            // Каждое следующее условие проверяется только на уже выбранных строках
+            output = input;
+            SelectionVector matched;
+            for (const auto& child : node.children) {
+                if (output.empty()) {
+                    break;
+                }
+                filterNode(child, rows, output, matched);
+                output.swap(matched);
+            }
+            return;
+        }
+
+        case Predicate::Kind::OR: {
+            // Каждое следующее условие проверяется только на еще не выбранных строках
+            output.clear();
+            SelectionVector rest = input;
+            SelectionVector matched;
+            SelectionVector merged;
+            for (const auto& child : node.children) {
+                if (rest.empty()) {
+                    break;
+                }
+                filterNode(child, rows, rest, matched);
+
+                merged.clear();
+                std::merge(output.begin(), output.end(), matched.begin(), matched.end(),
+                           std::back_inserter(merged));
+                output.swap(merged);
+
+                merged.clear();
+                std::set_difference(rest.begin(), rest.end(), matched.begin(), matched.end(),
+                                    std::back_inserter(merged));
+                rest.swap(merged);
+            }
+            return;
+        }
+    }
+}
+
+SelectionVector BatchFilter::filter(const std::vector<std::vector<std::string>>& rows,
+                                    const Predicate& predicate) {
+    SelectionVector result;
+    uint32_t rowCount = static_cast<uint32_t>(rows.size());
+
+    if (predicate.isTrue()) {
+        result.resize(rowCount);
+        std::iota(result.begin(), result.end(), 0);
+        return result;
+    }
+
+    SelectionVector batch;
+    SelectionVector selected;
+    for (uint32_t begin = 0; begin < rowCount; begin += BATCH_SIZE) {
+        uint32_t end = std::min<uint32_t>(begin + BATCH_SIZE, rowCount);
+        batch.resize(end - begin);
+        std::iota(batch.begin(), batch.end(), begin);
+
+        filterNode(predicate, rows, batch, selected);
+        result.insert(result.end(), selected.begin(), selected.end());
+    }
+
+    return result;
+}
@@ -0,0 +1,41 @@
+#include "bloom_filter.h"
+#include <functional>
+
+static const size_t BITS_PER_ITEM = 10;
+static const int HASH_COUNT = 3;
+
+BloomFilter::BloomFilter(size_t expectedItems) {
+    size_t bits = 64;
+    while (bits < expectedItems * BITS_PER_ITEM) {
+        bits <<= 1;
+    }
+    words.assign(bits / 64, 0);
+    mask = bits - 1;
+}
+
+// Двойное хэширование: i-я позиция = h1 + i * h2
+static void hashPair(std::string_view key, uint64_t& h1, uint64_t& h2) {
+    h1 = std::hash<std::string_view>()(key);
+    h2 = ((h1 * 0x9E3779B97F4A7C15ULL) >> 29) | 1;
+}
+
+void BloomFilter::add(std::string_view key) {
+    uint64_t h1, h2;
+    hashPair(key, h1, h2);
+    for (int i = 0; i < HASH_COUNT; ++i) {
+        uint64_t bit = (h1 + i * h2) & mask;
+        words[bit >> 6] |= uint64_t(1) << (bit & 63);
+    }
+}
+
+bool BloomFilter::mightContain(std::string_view key) const {
+    uint64_t h1, h2;
+    hashPair(key, h1, h2);
+    for (int i = 0; i < HASH_COUNT; ++i) {
+        uint64_t bit = (h1 + i * h2) & mask;
+        if (!(words[bit >> 6] & (uint64_t(1) << (bit & 63)))) {
+            return false;
+        }
+    }
+    return true;
+}
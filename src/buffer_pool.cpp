@@ -0,0 +1,185 @@
+#include "buffer_pool.h"
+#include "file_manager.h"
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+BufferPool& BufferPool::instance() {
+    static BufferPool pool;
+    return pool;
+}
+
+void BufferPool::setCapacity(size_t bytes) {
+    std::lock_guard<std::mutex> guard(mutex);
+    capacity = bytes;
+    evict(0);
+}
+
+size_t BufferPool::getCapacity() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return capacity;
+}
+
+size_t BufferPool::getUsedBytes() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return usedBytes;
+}
+
+size_t BufferPool::estimateBytes(const CSVRows& rows) {
+    size_t bytes = sizeof(CSVRows) + (rows.capacity() - rows.size()) * sizeof(std::vector<std::string>);
+    for (const auto& row : rows) {
+        bytes += estimateRowBytes(row);
+    }
+    return bytes;
+}
+
+size_t BufferPool::estimateRowBytes(const std::vector<std::string>& row) {
+    size_t bytes = sizeof(row) + row.capacity() * sizeof(std::string);
+    for (const auto& cell : row) {
+        if (cell.capacity() >= sizeof(std::string)) {
+            bytes += cell.capacity() + 1; // Строка вне SSO буфера
+        }
+    }
+    return bytes;
+}
+
+bool BufferPool::covers(const ColumnMask& parsed, const ColumnMask& needed) {
+    if (parsed.empty()) {
+        return true;
+    }
+    if (needed.empty()) {
+        return false;
+    }
+    for (size_t i = 0; i < needed.size(); ++i) {
+        if (needed[i] && (i >= parsed.size() || !parsed[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ColumnMask BufferPool::unite(const ColumnMask& a, const ColumnMask& b) {
+    if (a.empty() || b.empty()) {
+        return {};
+    }
+    ColumnMask result(std::max(a.size(), b.size()), false);
+    for (size_t i = 0; i < result.size(); ++i) {
+        result[i] = (i < a.size() && a[i]) || (i < b.size() && b[i]);
+    }
+    return result;
+}
+
+std::shared_ptr<const CSVRows> BufferPool::getChunk(const std::string& filepath, const ColumnMask& columns) {
+    std::error_code ec;
+    auto mtime = fs::last_write_time(filepath, ec);
+    uintmax_t fileSize = ec ? 0 : fs::file_size(filepath, ec);
+    if (ec) {
+        // Файла нет - поведение как у readCSVFile
+        return std::make_shared<const CSVRows>();
+    }
+
+    uint64_t version;
+    ColumnMask parseColumns = columns;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        auto it = entries.find(filepath);
+        if (it != entries.end()) {
+            Entry& entry = it->second;
+            // Файл мог быть изменен другим процессом
+            if (entry.mtime != mtime || entry.fileSize != fileSize) {
+                erase(filepath);
+            } else if (covers(entry.columns, columns)) {
+                lru.splice(lru.begin(), lru, entry.lruPos);
+                return entry.rows;
+            } else {
+                // Чанк разбирается заново с колонками обоих запросов и заменяет прежний
+                parseColumns = unite(entry.columns, columns);
+            }
+        }
+        Version& current = versions[filepath];
+        current.readers++;
+        version = current.value;
+    }
+
+    // Разбор файла выполняется без удержания блокировки
+    std::shared_ptr<const CSVRows> rows;
+    try {
+        rows = std::make_shared<const CSVRows>(FileManager::readCSVFile(filepath, parseColumns));
+    } catch (...) {
+        std::lock_guard<std::mutex> guard(mutex);
+        versions[filepath].readers--;
+        pruneVersion(filepath);
+        throw;
+    }
+    size_t bytes = estimateBytes(*rows);
+
+    std::lock_guard<std::mutex> guard(mutex);
+    Version& current = versions[filepath];
+    current.readers--;
+    if (bytes > capacity || current.value != version) {
+        pruneVersion(filepath);
+        return rows; // Чанк не помещается или был изменен во время чтения
+    }
+    auto it = entries.find(filepath);
+    if (it != entries.end()) {
+        if (covers(it->second.columns, parseColumns)) {
+            return rows; // Другой поток уже закэшировал не меньший набор колонок
+        }
+        erase(filepath);
+    }
+
+    evict(bytes);
+    lru.push_front(filepath);
+    entries[filepath] = Entry{rows, std::move(parseColumns), bytes, mtime, fileSize, lru.begin()};
+    usedBytes += bytes;
+    return rows;
+}
+
+void BufferPool::invalidate(const std::string& filepath) {
+    std::lock_guard<std::mutex> guard(mutex);
+    auto it = versions.find(filepath);
+    if (it != versions.end()) {
+        it->second.value++;
+    }
+    erase(filepath);
+}
+
+void BufferPool::clear() {
+    std::lock_guard<std::mutex> guard(mutex);
+    entries.clear();
+    lru.clear();
+    usedBytes = 0;
+    for (auto it = versions.begin(); it != versions.end();) {
+        if (it->second.readers == 0) {
+            it = versions.erase(it);
+        } else {
+            it->second.value++;
+            ++it;
+        }
+    }
+}
+
+void BufferPool::evict(size_t required) {
+    while (!lru.empty() && usedBytes + required > capacity) {
+        std::string victim = lru.back();
+        erase(victim);
+    }
+}
+
+void BufferPool::erase(const std::string& filepath) {
+    auto it = entries.find(filepath);
+    if (it == entries.end()) {
+        return;
+    }
+    usedBytes -= it->second.bytes;
+    lru.erase(it->second.lruPos);
+    entries.erase(it);
+    pruneVersion(filepath);
+}
+
+void BufferPool::pruneVersion(const std::string& filepath) {
+    auto it = versions.find(filepath);
+    if (it != versions.end() && it->second.readers == 0 && !entries.count(filepath)) {
+        versions.erase(it);
+    }
+}
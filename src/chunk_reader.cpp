@@ -0,0 +1,47 @@
+#include "chunk_reader.h"
+#include "file_manager.h"
+#include "thread_pool.h"
+
+ChunkReader::ChunkReader(std::vector<std::string> files, size_t depth, ColumnMask columns)
+    : files(std::move(files)), depth(depth), columns(std::move(columns)) {
+    schedule();
+}
+
+ChunkReader::~ChunkReader() {
+    // Сканирование могло завершиться досрочно (LIMIT): задачи ссылаются
+    // на пул буферов, поэтому дожидаемся их до выхода из запроса
+    for (auto& future : pending) {
+        future.wait();
+    }
+}
+
+void ChunkReader::schedule() {
+    while (pending.size() < depth && scheduled < files.size()) {
+        std::string path = files[scheduled++];
+        pending.push_back(ThreadPool::instance().submit([this, path]() {
+            return FileManager::readChunk(path, columns);
+        }));
+    }
+}
+
+bool ChunkReader::next(std::shared_ptr<const CSVRows>& rows) {
+    if (current >= files.size()) {
+        return false;
+    }
+
+    if (pending.empty()) {
+        // Упреждение выключено - синхронное чтение
+        rows = FileManager::readChunk(files[current++], columns);
+        return true;
+    }
+
+    rows = pending.front().get();
+    pending.pop_front();
+    current++;
+    schedule();
+    return true;
+}
+
+const std::string& ChunkReader::currentFile() const {
+    return files[current - 1];
+}
@@ -3,84 +3,444 @@
 #include <sstream>
 #include <iostream>
 #include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
 
-DatabaseConfig DatabaseConfig::loadFromFile(const std::string& filename) {
+namespace fs = std::filesystem;
+
+// Версия формата бинарного каталога; увеличивается при изменении полей конфигурации
+static const char CATALOG_MAGIC[] = "DBMSCAT";
+static const uint32_t CATALOG_VERSION = 4;
+
+namespace {
+
+// Однопроходный разбор JSON без построения дерева
+class JsonReader {
+public:
+    explicit JsonReader(const std::string& text) : text(text) {}
+
+    void skipSpace() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+            pos++;
+        }
+    }
+
+    char peek() {
+        skipSpace();
+        return pos < text.size() ? text[pos] : '\0';
+    }
+
+    bool consume(char c) {
+        if (peek() == c) {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) {
+            fail(std::string("expected '") + c + "'");
+        }
+    }
+
+    std::string readString() {
+        expect('"');
+        std::string value;
+        while (pos < text.size() && text[pos] != '"') {
+            char c = text[pos++];
+            if (c != '\\') {
+                value += c;
+                continue;
+            }
+            if (pos >= text.size()) break;
+            char escaped = text[pos++];
+            switch (escaped) {
+                case 'n': value += '\n'; break;
+                case 't': value += '\t'; break;
+                case 'r': value += '\r'; break;
+                case 'b': value += '\b'; break;
+                case 'f': value += '\f'; break;
+                case 'u': appendCodePoint(value, readCodePoint()); break;
+                default: value += escaped; break; // \" \\ \/
+            }
+        }
+        expect('"');
+        return value;
+    }
+
+    std::string readNumber() {
+        skipSpace();
+        size_t start = pos;
+        while (pos < text.size() && (std::isdigit(static_cast<unsigned char>(text[pos])) ||
+                                     std::strchr("+-.eE", text[pos]) != nullptr)) {
+            pos++;
+        }
+        if (start == pos) {
+            fail("expected number");
+        }
+        return text.substr(start, pos - start);
+    }
+
+    // Пропуск значения неизвестного ключа
+    void skipValue() {
+        char c = peek();
+        if (c == '"') {
+            readString();
+        } else if (c == '{' || c == '[') {
+            char close = c == '{' ? '}' : ']';
+            pos++;
+            if (consume(close)) return;
+            do {
+                if (c == '{') {
+                    readString();
+                    expect(':');
+                }
+                skipValue();
+            } while (consume(','));
+            expect(close);
+        } else if (c == '-' || std::isdigit(static_cast<unsigned char>(c))) {
+            readNumber();
+        } else {
+            // true, false, null
+            while (pos < text.size() && std::isalpha(static_cast<unsigned char>(text[pos]))) pos++;
+        }
+    }
+
+    [[noreturn]] void fail(const std::string& message) {
+        throw std::runtime_error("Invalid schema.json at offset " + std::to_string(pos) + ": " + message);
+    }
+
+private:
+    uint32_t readHex() {
+        if (pos + 4 > text.size()) fail("bad \\u escape");
+        uint32_t code = std::stoul(text.substr(pos, 4), nullptr, 16);
+        pos += 4;
+        return code;
+    }
+
+    uint32_t readCodePoint() {
+        uint32_t code = readHex();
+        // Суррогатная пара UTF-16
+        if (code >= 0xD800 && code <= 0xDBFF && text.compare(pos, 2, "\\u") == 0) {
+            pos += 2;
+            uint32_t low = readHex();
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        }
+        return code;
+    }
+
+    static void appendCodePoint(std::string& out, uint32_t code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    const std::string& text;
+    size_t pos = 0;
+};
+
+// Пробелы в именах схемы, таблиц и колонок не учитываются (имена служат путями на диске)
+std::string stripSpaces(std::string value) {
+    value.erase(std::remove_if(value.begin(), value.end(),
+        [](char c) { return std::isspace(static_cast<unsigned char>(c)); }), value.end());
+    return value;
+}
+
+// Чтение и запись полей бинарного каталога
+class CatalogWriter {
+public:
+    void writeU64(uint64_t value) { data.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+    void writeString(const std::string& value) {
+        writeU64(value.size());
+        data.append(value);
+    }
+
+    std::string data;
+};
+
+class CatalogReader {
+public:
+    explicit CatalogReader(const std::string& data) : data(data) {}
+
+    bool readU64(uint64_t& value) {
+        if (pos + sizeof(value) > data.size()) return false;
+        std::memcpy(&value, data.data() + pos, sizeof(value));
+        pos += sizeof(value);
+        return true;
+    }
+
+    bool readString(std::string& value) {
+        uint64_t length;
+        if (!readU64(length) || length > data.size() - pos) return false;
+        value.assign(data, pos, length);
+        pos += length;
+        return true;
+    }
+
+    bool atEnd() const { return pos == data.size(); }
+
+private:
+    const std::string& data;
+    size_t pos = 0;
+};
+
+} // namespace
+
+DatabaseConfig DatabaseConfig::parseJSON(const std::string& content) {
     DatabaseConfig config;
-    std::ifstream file(filename);
+    config.tuples_limit = 1000;
+    config.buffer_pool_size = 64 * 1024 * 1024;
+    config.read_ahead = 4;
+    config.pk_cache_size = 100;
+    config.query_memory_limit = 256 * 1024 * 1024;
+    config.durability = Durability::FLUSH;
+    config.group_commit_ms = 10;
     
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot open schema.json");
+    JsonReader reader(content);
+    reader.expect('{');
+    if (reader.consume('}')) {
+        return config;
     }
     
-    std::string line;
-    std::string content;
-    while (std::getline(file, line)) {
-        content += line;
+    do {
+        std::string key = reader.readString();
+        reader.expect(':');
+        
+        if (key == "name") {
+            config.name = stripSpaces(reader.readString());
+        } else if (key == "tuples_limit") {
+            config.tuples_limit = std::stoi(reader.readNumber());
+        } else if (key == "buffer_pool_size") {
+            config.buffer_pool_size = std::stoull(reader.readNumber());
+        } else if (key == "read_ahead") {
+            config.read_ahead = std::stoull(reader.readNumber());
+        } else if (key == "pk_cache_size") {
+            config.pk_cache_size = std::stoll(reader.readNumber());
+        } else if (key == "query_memory_limit") {
+            config.query_memory_limit = std::stoull(reader.readNumber());
+        } else if (key == "durability") {
+            config.durability = parseDurability(reader.readString());
+        } else if (key == "group_commit_ms") {
+            config.group_commit_ms = std::stoull(reader.readNumber());
+        } else if (key == "structure") {
+            reader.expect('{');
+            if (reader.consume('}')) continue;
+            do {
+                std::string tableName = stripSpaces(reader.readString());
+                reader.expect(':');
+                reader.expect('[');
+                
+                // Колонка задается строкой "имя" или объектом {"name":"имя","type":"int64"}
+                std::vector<std::string> columns;
+                if (!reader.consume(']')) {
+                    do {
+                        if (reader.peek() != '{') {
+                            columns.push_back(stripSpaces(reader.readString()));
+                            continue;
+                        }
+                        
+                        reader.expect('{');
+                        std::string colName;
+                        std::string typeName;
+                        bool hasType = false;
+                        if (!reader.consume('}')) {
+                            do {
+                                std::string field = reader.readString();
+                                reader.expect(':');
+                                if (field == "name") {
+                                    colName = stripSpaces(reader.readString());
+                                } else if (field == "type") {
+                                    typeName = reader.readString();
+                                    hasType = true;
+                                } else {
+                                    reader.skipValue();
+                                }
+                            } while (reader.consume(','));
+                            reader.expect('}');
+                        }
+                        if (hasType) {
+                            config.columnTypes[tableName][colName] = ColumnTypes::parseType(typeName);
+                        }
+                        columns.push_back(colName);
+                    } while (reader.consume(','));
+                    reader.expect(']');
+                }
+                
+                config.structure[tableName] = columns;
+            } while (reader.consume(','));
+            reader.expect('}');
+        } else {
+            reader.skipValue();
+        }
+    } while (reader.consume(','));
+    reader.expect('}');
+    
+    return config;
+}
+
+bool DatabaseConfig::loadCatalog(const std::string& catalogPath, uint64_t sourceTime, uint64_t sourceSize,
+                                 DatabaseConfig& config) {
+    std::ifstream file(catalogPath, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
     }
-    file.close();
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
     
-    // Простой парсер JSON для нашего формата
-    // Удаление пробелов
-    content.erase(std::remove_if(content.begin(), content.end(), 
-        [](char c) { return std::isspace(c); }), content.end());
+    if (data.compare(0, sizeof(CATALOG_MAGIC), CATALOG_MAGIC, sizeof(CATALOG_MAGIC)) != 0) {
+        return false;
+    }
+    std::string body = data.substr(sizeof(CATALOG_MAGIC));
+    CatalogReader reader(body);
     
-    // Извлечение имени схемы
-    size_t namePos = content.find("\"name\":\"");
-    if (namePos != std::string::npos) {
-        namePos += 8;
-        size_t nameEnd = content.find("\"", namePos);
-        config.name = content.substr(namePos, nameEnd - namePos);
+    // Каталог действителен, только если schema.json не менялся после его записи
+    uint64_t version, time, size;
+    if (!reader.readU64(version) || version != CATALOG_VERSION ||
+        !reader.readU64(time) || time != sourceTime ||
+        !reader.readU64(size) || size != sourceSize) {
+        return false;
     }
     
-    // Извлечение tuples_limit
-    size_t limitPos = content.find("\"tuples_limit\":");
-    if (limitPos != std::string::npos) {
-        limitPos += 15;
-        size_t limitEnd = content.find_first_of(",}", limitPos);
-        config.tuples_limit = std::stoi(content.substr(limitPos, limitEnd - limitPos));
+    uint64_t tuplesLimit, pkCacheSize, durability, tableCount;
+    if (!reader.readString(config.name) || !reader.readU64(tuplesLimit) ||
+        !reader.readU64(config.buffer_pool_size) || !reader.readU64(config.read_ahead) ||
+        !reader.readU64(pkCacheSize) || !reader.readU64(config.query_memory_limit) ||
+        !reader.readU64(durability) || !reader.readU64(config.group_commit_ms) ||
+        !reader.readU64(tableCount)) {
+        return false;
     }
+    config.durability = static_cast<Durability>(durability);
+    config.tuples_limit = static_cast<int>(tuplesLimit);
+    config.pk_cache_size = static_cast<long long>(pkCacheSize);
     
-    // Извлечение структуры
-    size_t structPos = content.find("\"structure\":{");
-    if (structPos != std::string::npos) {
-        structPos += 13;
-        size_t structEnd = content.find_last_of("}");
-        
-        std::string structContent = content.substr(structPos, structEnd - structPos);
+    for (uint64_t t = 0; t < tableCount; ++t) {
+        std::string tableName;
+        uint64_t columnCount;
+        if (!reader.readString(tableName) || !reader.readU64(columnCount)) {
+            return false;
+        }
         
-        size_t pos = 0;
-        while (pos < structContent.length()) {
-            // Поиск имени таблицы
-            size_t tableStart = structContent.find("\"", pos);
-            if (tableStart == std::string::npos) break;
-            tableStart += 1;
-            size_t tableEnd = structContent.find("\"", tableStart);
-            std::string tableName = structContent.substr(tableStart, tableEnd - tableStart);
-            
-            // Поиск массива колонок
-            size_t arrayStart = structContent.find("[", tableEnd);
-            if (arrayStart == std::string::npos) break;
-            size_t arrayEnd = structContent.find("]", arrayStart);
-            
-            std::string arrayContent = structContent.substr(arrayStart + 1, arrayEnd - arrayStart - 1);
-            
-            std::vector<std::string> columns;
-            size_t colPos = 0;
-            while (colPos < arrayContent.length()) {
-                size_t colStart = arrayContent.find("\"", colPos);
-                if (colStart == std::string::npos) break;
-                colStart += 1;
-                size_t colEnd = arrayContent.find("\"", colStart);
-                std::string colName = arrayContent.substr(colStart, colEnd - colStart);
-                columns.push_back(colName);
-                colPos = colEnd + 1;
+        auto& columns = config.structure[tableName];
+        for (uint64_t c = 0; c < columnCount; ++c) {
+            std::string colName;
+            uint64_t type;
+            if (!reader.readString(colName) || !reader.readU64(type)) {
+                return false;
             }
-            
-            config.structure[tableName] = columns;
-            pos = arrayEnd + 1;
+            if (type != static_cast<uint64_t>(ColumnType::STRING)) {
+                config.columnTypes[tableName][colName] = static_cast<ColumnType>(type);
+            }
+            columns.push_back(colName);
+        }
+    }
+    
+    return reader.atEnd();
+}
+
+void DatabaseConfig::saveCatalog(const std::string& catalogPath, uint64_t sourceTime, uint64_t sourceSize,
+                                 const DatabaseConfig& config) {
+    CatalogWriter writer;
+    writer.data.append(CATALOG_MAGIC, sizeof(CATALOG_MAGIC));
+    writer.writeU64(CATALOG_VERSION);
+    writer.writeU64(sourceTime);
+    writer.writeU64(sourceSize);
+    writer.writeString(config.name);
+    writer.writeU64(static_cast<uint64_t>(config.tuples_limit));
+    writer.writeU64(config.buffer_pool_size);
+    writer.writeU64(config.read_ahead);
+    writer.writeU64(static_cast<uint64_t>(config.pk_cache_size));
+    writer.writeU64(config.query_memory_limit);
+    writer.writeU64(static_cast<uint64_t>(config.durability));
+    writer.writeU64(config.group_commit_ms);
+    writer.writeU64(config.structure.size());
+    for (const auto& [tableName, columns] : config.structure) {
+        writer.writeString(tableName);
+        writer.writeU64(columns.size());
+        for (const auto& colName : columns) {
+            writer.writeString(colName);
+            writer.writeU64(static_cast<uint64_t>(config.getColumnType(tableName, colName)));
         }
     }
     
+    // Каталог - только кэш: при ошибке записи конфигурация просто разбирается заново
+    std::string tempPath = catalogPath + ".tmp";
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return;
+    }
+    file.write(writer.data.data(), writer.data.size());
+    file.close();
+    
+    std::error_code ec;
+    if (file.fail()) {
+        fs::remove(tempPath, ec);
+        return;
+    }
+    fs::rename(tempPath, catalogPath, ec);
+}
+
+DatabaseConfig DatabaseConfig::loadFromFile(const std::string& filename) {
+    std::error_code ec;
+    auto mtime = fs::last_write_time(filename, ec);
+    uint64_t fileSize = ec ? 0 : fs::file_size(filename, ec);
+    if (ec) {
+        throw std::runtime_error("Cannot open schema.json");
+    }
+    uint64_t fileTime = static_cast<uint64_t>(mtime.time_since_epoch().count());
+    
+    // Быстрый путь: каталог, сохраненный при предыдущем запуске
+    std::string catalogPath = filename + ".catalog";
+    DatabaseConfig config;
+    if (loadCatalog(catalogPath, fileTime, fileSize, config)) {
+        return config;
+    }
+    
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open schema.json");
+    }
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    
+    config = parseJSON(content);
+    saveCatalog(catalogPath, fileTime, fileSize, config);
     return config;
 }
 
+
+Durability DatabaseConfig::parseDurability(const std::string& value) {
+    std::string name = value;
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    if (name == "none") return Durability::NONE;
+    if (name == "flush") return Durability::FLUSH;
+    if (name == "fsync") return Durability::FSYNC;
+    throw std::runtime_error("Invalid durability '" + value + "' (expected none, flush or fsync)");
+}
+
+ColumnType DatabaseConfig::getColumnType(const std::string& tableName, const std::string& columnName) const {
+    if (columnName == tableName + "_pk") {
+        return ColumnType::INT64;
+    }
+    
+    auto tableIt = columnTypes.find(tableName);
+    if (tableIt == columnTypes.end()) {
+        return ColumnType::STRING;
+    }
+    
+    auto colIt = tableIt->second.find(columnName);
+    return colIt != tableIt->second.end() ? colIt->second : ColumnType::STRING;
+}
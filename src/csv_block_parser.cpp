@@ -0,0 +1,123 @@
+#include "csv_block_parser.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+
+// Части меньше этого размера не стоит отдавать в отдельный поток
+static const size_t MIN_PART_SIZE = 256 * 1024;
+
+CSVBlockParser::CSVBlockParser(std::vector<std::string> columns, std::vector<ColumnType> types,
+                               size_t skipLeading, size_t reserved)
+    : columns(std::move(columns)), types(std::move(types)), skipLeading(skipLeading), reserved(reserved) {
+}
+
+std::vector<std::string> CSVBlockParser::splitLine(const std::string& line) {
+    std::vector<std::string> cells;
+    size_t end = line.size();
+    if (end > 0 && line[end - 1] == '\r') {
+        end--;
+    }
+
+    size_t start = 0;
+    while (true) {
+        size_t comma = line.find(',', start);
+        if (comma == std::string::npos || comma >= end) {
+            cells.push_back(line.substr(start, end - start));
+            break;
+        }
+        cells.push_back(line.substr(start, comma - start));
+        start = comma + 1;
+    }
+    return cells;
+}
+
+CSVRows CSVBlockParser::parseRange(const char* begin, const char* end) const {
+    CSVRows rows;
+    size_t fieldCount = skipLeading + columns.size();
+
+    const char* line = begin;
+    while (line < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        if (lineEnd == nullptr) {
+            lineEnd = end;
+        }
+        const char* contentEnd = lineEnd;
+        if (contentEnd > line && contentEnd[-1] == '\r') {
+            contentEnd--;
+        }
+
+        if (contentEnd > line) {
+            std::vector<std::string> row(reserved);
+            row.reserve(reserved + columns.size());
+
+            size_t field = 0;
+            const char* cell = line;
+            while (true) {
+                const char* comma = static_cast<const char*>(std::memchr(cell, ',', contentEnd - cell));
+                const char* cellEnd = comma != nullptr ? comma : contentEnd;
+                if (field >= skipLeading) {
+                    row.emplace_back(cell, cellEnd);
+                }
+                field++;
+                if (comma == nullptr) break;
+                cell = comma + 1;
+            }
+
+            if (field != fieldCount) {
+                throw std::runtime_error("Column count mismatch in line: " + std::string(line, contentEnd));
+            }
+            for (size_t i = 0; i < columns.size(); ++i) {
+                const std::string& value = row[reserved + i];
+                if (!ColumnTypes::isValid(value, types[i])) {
+                    throw std::runtime_error("Invalid " + ColumnTypes::typeName(types[i]) + " value '" +
+                                             value + "' for column " + columns[i]);
+                }
+            }
+            rows.push_back(std::move(row));
+        }
+
+        line = lineEnd + 1;
+    }
+
+    return rows;
+}
+
+CSVRows CSVBlockParser::parse(const char* begin, const char* end) const {
+    size_t size = end - begin;
+    size_t partCount = std::max<size_t>(1, std::min(ThreadPool::instance().size(), size / MIN_PART_SIZE));
+    if (partCount == 1) {
+        return parseRange(begin, end);
+    }
+
+    // Границы частей сдвигаются к концу строки
+    std::vector<const char*> bounds{begin};
+    for (size_t i = 1; i < partCount; ++i) {
+        const char* bound = std::max(bounds.back(), begin + size * i / partCount);
+        const char* newline = static_cast<const char*>(std::memchr(bound, '\n', end - bound));
+        bounds.push_back(newline != nullptr ? newline + 1 : end);
+    }
+    bounds.push_back(end);
+
+    std::vector<std::future<CSVRows>> parts;
+    for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+        const char* partBegin = bounds[i];
+        const char* partEnd = bounds[i + 1];
+        parts.push_back(ThreadPool::instance().submit([this, partBegin, partEnd]() {
+            return parseRange(partBegin, partEnd);
+        }));
+    }
+
+    // Все части дожидаются до выхода (даже при ошибке), так как ссылаются на блок
+    for (auto& part : parts) {
+        part.wait();
+    }
+
+    CSVRows rows = parts[0].get();
+    for (size_t i = 1; i < parts.size(); ++i) {
+        CSVRows partRows = parts[i].get();
+        rows.insert(rows.end(), std::make_move_iterator(partRows.begin()), std::make_move_iterator(partRows.end()));
+    }
+    return rows;
+}
@@ -1,16 +1,277 @@
 #include "database.h"
+#include "buffer_pool.h"
+#include "batch_filter.h"
+#include "aggregator.h"
+#include "row_sorter.h"
+#include "planner.h"
+#include "chunk_reader.h"
+#include "query_arena.h"
+#include "csv_block_parser.h"
+#include "bloom_filter.h"
+#include "memory_budget.h"
+#include "spill_file.h"
+#include "thread_pool.h"
 #include <algorithm>
+#include <cstring>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
 #include <iostream>
 #include <sstream>
 #include <functional>
 #include <fstream>
+#include <unordered_map>
+#include <filesystem>
+
+// Ключ хэш-соединения: значение в типе условия, чтобы, например, '01' и '1' в int64 совпадали.
+// Строковый ключ - само значение; типизированный собирается в buffer без новых выделений
+static std::string_view joinKey(const std::string& value, ColumnType type, std::string& buffer) {
+    if (type == ColumnType::STRING) {
+        return value;
+    }
+    
+    TypedValue typed = ColumnTypes::convert(value, type);
+    buffer.clear();
+    if (!typed.valid) {
+        buffer += 's';
+        buffer += value;
+    } else if (type == ColumnType::DOUBLE) {
+        buffer += 'd';
+        buffer += ColumnTypes::formatDouble(typed.doubleValue == 0.0 ? 0.0 : typed.doubleValue);
+    } else {
+        buffer += 'i';
+        buffer += std::to_string(typed.intValue);
+    }
+    return buffer;
+}
+
+// Новые строки получают ключи больше всех выданных (PKSequence), поэтому
+// упорядоченность первичного ключа сохраняется, а остальных колонок - нет.
+// Возвращает true, если флаги упорядоченности изменились
+static bool keepPKOrder(TableStats& stats, const std::string& tableName) {
+    bool pkSorted = stats.isSorted(tableName + "_pk");
+    size_t sortedCount = stats.sortedColumns.size();
+    stats.sortedColumns.clear();
+    if (pkSorted) {
+        stats.sortedColumns.insert(tableName + "_pk");
+    }
+    return stats.sortedColumns.size() != sortedCount;
+}
+
+// Пустой или некорректный ключ типизированной колонки ни с чем не соединяется
+// (как и в условиях WHERE), поэтому в хэш-таблицу стороны build не попадает
+static bool isJoinable(const std::string& value, ColumnType type) {
+    return type == ColumnType::STRING || ColumnTypes::convert(value, type).valid;
+}
+
+static const std::string& cellValue(const std::vector<std::string>& row, int column) {
+    static const std::string emptyValue;
+    if (column < 0 || static_cast<size_t>(column) >= row.size()) {
+        return emptyValue;
+    }
+    return row[column];
+}
+
+// Фильтр полусоединения: ключи стороны build, проверяемые при сканировании
+// таблицы, с которой она соединяется (строки без пары отбрасываются до соединения)
+struct SemiJoinFilter {
+    int column;         // Колонка ключа в сканируемой таблице
+    ColumnType keyType;
+    BloomFilter bloom;
+};
+
+static void applySemiJoinFilters(const CSVRows& rows, const std::vector<const SemiJoinFilter*>& filters,
+                                 SelectionVector& selection, std::string& keyBuffer) {
+    for (const auto* filter : filters) {
+        size_t kept = 0;
+        for (uint32_t rowIndex : selection) {
+            std::string_view key = joinKey(cellValue(rows[rowIndex], filter->column), filter->keyType, keyBuffer);
+            selection[kept] = rowIndex;
+            kept += filter->bloom.mightContain(key);
+        }
+        selection.resize(kept);
+    }
+}
+
+// Размер блока чтения для COPY FROM и COPY TO
+static const size_t COPY_BLOCK_SIZE = 16 * 1024 * 1024;
+
+// Состояние потока, обрабатывающего строки внешней таблицы
+struct ProbeContext {
+    Tuple tuple;
+    std::string keyBuffer;
+    std::vector<const std::string*> groupKey;
+    std::vector<const std::string*> aggregateArgs;
+    HashAggregator* aggregator = nullptr;                   // Частичные агрегаты текущего чанка
+    std::vector<std::vector<std::string>>* rows = nullptr; // Строки морсела (nullptr - выдаются сразу)
+    
+    ProbeContext(size_t tableCount, size_t groupCount, size_t columnCount)
+        : tuple(tableCount, nullptr), groupKey(groupCount), aggregateArgs(columnCount) {}
+};
+
+// Разделы для сброса групп агрегации на диск
+static const size_t AGGREGATE_PARTITIONS = 16;
+
+// Сколько морселов на поток может обрабатываться и ждать выдачи при параллельном сканировании
+static const size_t MORSEL_WINDOW_PER_THREAD = 2;
+
+// Примерные накладные расходы хэш-таблицы соединения на один ключ
+static const size_t HASH_ENTRY_OVERHEAD = 64;
+
+// Материализованная сторона build: строки таблицы после фильтра сканирования
+// (списки строк и хэш-таблица в своей арене, ключи интернированы). Удерживаемые
+// чанки и хэш-таблица учитываются в бюджете памяти запроса
+struct BuildSide {
+    using RowList = std::pmr::vector<const std::vector<std::string>*>;
+    
+    QueryArena arena;
+    std::vector<std::shared_ptr<const CSVRows>> chunks; // Удерживают строки в памяти
+    RowList rows;
+    std::pmr::unordered_map<std::string_view, RowList> hashTable;
+    MemoryBudget& budget;
+    size_t bytes = 0;
+    
+    explicit BuildSide(MemoryBudget& budget)
+        : rows(arena.resource()), hashTable(arena.resource()), budget(budget) {}
+    ~BuildSide() { budget.release(bytes); }
+    
+    void reserve(size_t size) {
+        budget.reserve(size);
+        bytes += size;
+    }
+};
+
+// Потоковая сторона соединения слиянием: таблица читается по чанкам в порядке
+// ключа синхронно с внешней. В памяти - текущий чанк и строки с текущим ключом
+// (для первичного ключа - не больше одной строки)
+class MergeCursor {
+public:
+    MergeCursor(std::vector<std::string> files, size_t readAhead, ColumnMask columns, const PlanLevel& level,
+                const std::vector<const SemiJoinFilter*>& semiJoins, std::pmr::memory_resource* memory)
+        : reader(std::move(files), readAhead, std::move(columns)), level(level), semiJoins(semiJoins), run(memory) {
+        loadChunk();
+    }
+    
+    MergeCursor(const MergeCursor&) = delete;
+    MergeCursor& operator=(const MergeCursor&) = delete;
+    
+    // Строки с ключом, равным value. Ключи внешней таблицы не убывают,
+    // поэтому пропущенные строки больше не понадобятся
+    const BuildSide::RowList& seek(const std::string& value) {
+        TypedValue key = ColumnTypes::convert(value, level.keyType);
+        if (!key.valid) {
+            return emptyRun;
+        }
+        if (hasRun) {
+            int cmp = ColumnTypes::compare(key, runKey, level.keyType);
+            if (cmp == 0) {
+                return run;
+            }
+            if (cmp < 0) {
+                return emptyRun;
+            }
+        }
+        
+        run.clear();
+        runChunks.clear();
+        runValue = value;
+        runKey = ColumnTypes::convert(runValue, level.keyType);
+        hasRun = true;
+        
+        while (chunk) {
+            const auto& row = (*chunk)[selection[position]];
+            int cmp = ColumnTypes::compare(ColumnTypes::convert(cellValue(row, level.buildKey.column), level.keyType),
+                                           runKey, level.keyType);
+            if (cmp > 0) {
+                break;
+            }
+            if (cmp == 0) {
+                if (runChunks.empty() || runChunks.back() != chunk) {
+                    runChunks.push_back(chunk);
+                }
+                run.push_back(&row);
+            }
+            if (++position == selection.size()) {
+                loadChunk();
+            }
+        }
+        return run;
+    }
+    
+private:
+    // Следующий чанк со строками, прошедшими фильтры сканирования
+    void loadChunk() {
+        std::string keyBuffer;
+        while (reader.next(chunk)) {
+            selection = BatchFilter::filter(*chunk, level.scanFilter);
+            applySemiJoinFilters(*chunk, semiJoins, selection, keyBuffer);
+            if (!selection.empty()) {
+                position = 0;
+                return;
+            }
+        }
+        chunk.reset();
+    }
+    
+    ChunkReader reader;
+    const PlanLevel& level;
+    const std::vector<const SemiJoinFilter*>& semiJoins;
+    std::shared_ptr<const CSVRows> chunk;
+    SelectionVector selection;
+    size_t position = 0;
+    
+    BuildSide::RowList run;                               // Строки с текущим ключом
+    std::vector<std::shared_ptr<const CSVRows>> runChunks; // Удерживают строки run
+    std::string runValue;
+    TypedValue runKey{};
+    bool hasRun = false;
+    const BuildSide::RowList emptyRun;
+};
 
 Database::Database(const DatabaseConfig& config) : config(config) {
     schemaName = config.name;
+    BufferPool::instance().setCapacity(config.buffer_pool_size);
+}
+
+Database::~Database() {
+    if (groupCommitThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> guard(statementMutex);
+            stopGroupCommit = true;
+        }
+        groupCommitWake.notify_one();
+        groupCommitThread.join();
+    }
+    try {
+        commitAllPendingRows();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+    }
+    try {
+        flushStatistics();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+    }
 }
 
 void Database::initialize() {
-    FileManager::initializeDatabase(schemaName, config.structure);
+    FileManager::initializeDatabase(schemaName);
+}
+
+std::string Database::openTable(const std::string& tableName) {
+    std::string tablePath = FileManager::getTablePath(schemaName, tableName);
+    if (openedTables.count(tableName)) {
+        return tablePath;
+    }
+    
+    // Таблица из схемы создается на диске при первом обращении
+    auto it = config.structure.find(tableName);
+    if (it != config.structure.end()) {
+        FileManager::initializeTable(tablePath, tableName, it->second);
+        openedTables.insert(tableName);
+    }
+    return tablePath;
 }
 
 std::vector<std::string> Database::getTableHeader(const std::string& tablePath, const std::string& /*tableName*/) {
@@ -39,145 +300,836 @@ std::vector<std::string> Database::getTableHeader(const std::string& tablePath,
     return header;
 }
 
-bool Database::evaluateCondition(const Condition& cond, 
-                                 const std::map<std::string, std::vector<std::string>>& rowData,
-                                 const std::map<std::string, std::vector<std::string>>& tableHeaders) {
-    std::string leftValue;
-    std::string rightValue;
-    
-    // Получение левого значения
-    if (rowData.find(cond.leftTable) != rowData.end() && 
-        tableHeaders.find(cond.leftTable) != tableHeaders.end()) {
-        const auto& row = rowData.at(cond.leftTable);
-        const auto& header = tableHeaders.at(cond.leftTable);
+std::vector<ColumnType> Database::getTableTypes(const std::string& tableName, const std::vector<std::string>& header) {
+    std::vector<ColumnType> types;
+    for (const auto& column : header) {
+        types.push_back(config.getColumnType(tableName, column));
+    }
+    return types;
+}
+
+void Database::validateConditions(const std::vector<Condition>& conditions) {
+    for (const auto& cond : conditions) {
+        CompareOp op = ColumnTypes::parseOperator(cond.operator_);
+        if (op == CompareOp::INVALID) {
+            throw std::runtime_error("Unsupported operator: " + cond.operator_);
+        }
+        if (!cond.isLiteral) {
+            continue;
+        }
         
-        auto it = std::find(header.begin(), header.end(), cond.leftColumn);
-        if (it != header.end()) {
-            size_t index = std::distance(header.begin(), it);
-            if (index < row.size()) {
-                leftValue = row[index];
-            }
+        ColumnType type = config.getColumnType(cond.leftTable, cond.leftColumn);
+        if (!ColumnTypes::isValid(cond.rightValue, type) ||
+            (op == CompareOp::BETWEEN && !ColumnTypes::isValid(cond.rightValue2, type))) {
+            throw std::runtime_error("Invalid " + ColumnTypes::typeName(type) + " value in condition on " +
+                                     cond.leftTable + "." + cond.leftColumn);
+        }
+    }
+}
+
+PKSequence& Database::getPKSequence(const std::string& tableName) {
+    std::lock_guard<std::mutex> guard(pkSequencesMutex);
+    auto& sequence = pkSequences[tableName];
+    if (!sequence) {
+        sequence = std::make_unique<PKSequence>(openTable(tableName), tableName, config.pk_cache_size);
+    }
+    return *sequence;
+}
+
+TableWriter& Database::getTableWriter(const std::string& tableName, const std::string& tablePath) {
+    auto& writer = tableWriters[tableName];
+    if (!writer) {
+        auto header = getTableHeader(tablePath, tableName);
+        if (header.empty()) {
+            tableWriters.erase(tableName);
+            throw std::runtime_error("Cannot read table structure");
         }
+        writer = std::make_unique<TableWriter>(tablePath, std::move(header), config.tuples_limit);
+    }
+    return *writer;
+}
+
+void Database::commitPendingRows(const std::string& tableName, bool tableLocked) {
+    auto it = tableWriters.find(tableName);
+    if (it == tableWriters.end() || it->second->pendingRows() == 0) {
+        return;
+    }
+    if (tableLocked) {
+        try {
+            it->second->commit(config.durability, getPKSequence(tableName));
+        } catch (...) {
+            groupCommitted.notify_all();
+            throw;
+        }
+        groupCommitted.notify_all();
+        return;
     }
     
-    // Получение правого значения
-    if (cond.isLiteral) {
-        rightValue = cond.rightValue;
-    } else {
-        if (rowData.find(cond.rightTable) != rowData.end() && 
-            tableHeaders.find(cond.rightTable) != tableHeaders.end()) {
-            const auto& row = rowData.at(cond.rightTable);
-            const auto& header = tableHeaders.at(cond.rightTable);
-            
-            auto it = std::find(header.begin(), header.end(), cond.rightColumn);
-            if (it != header.end()) {
-                size_t index = std::distance(header.begin(), it);
-                if (index < row.size()) {
-                    rightValue = row[index];
+    std::string tablePath = FileManager::getTablePath(schemaName, tableName);
+    if (!FileManager::lockTable(tablePath, tableName)) {
+        // INSERT при flush и fsync ждут группу: она отбрасывается, как при ошибке записи
+        std::string error = "Table " + tableName + " is locked";
+        if (config.durability != Durability::NONE) {
+            it->second->abandon(error);
+            groupCommitted.notify_all();
+        }
+        throw std::runtime_error(error);
+    }
+    try {
+        it->second->commit(config.durability, getPKSequence(tableName));
+    } catch (...) {
+        FileManager::unlockTable(tablePath, tableName);
+        groupCommitted.notify_all();
+        throw;
+    }
+    FileManager::unlockTable(tablePath, tableName);
+    groupCommitted.notify_all();
+}
+
+void Database::commitAllPendingRows() {
+    for (const auto& [tableName, writer] : tableWriters) {
+        commitPendingRows(tableName, false);
+    }
+}
+
+void Database::groupCommitLoop() {
+    std::unique_lock<std::mutex> lock(statementMutex);
+    while (!stopGroupCommit) {
+        std::chrono::milliseconds window(config.group_commit_ms);
+        auto now = std::chrono::steady_clock::now();
+        
+        // Истекшие группы записываются, поток спит до ближайшего окна остальных
+        bool waiting = false;
+        std::chrono::steady_clock::time_point wakeAt;
+        for (const auto& [tableName, writer] : tableWriters) {
+            if (writer->pendingRows() == 0) {
+                continue;
+            }
+            auto deadline = writer->deadline(window);
+            if (deadline <= now) {
+                try {
+                    commitPendingRows(tableName, false);
+                    continue;
+                } catch (const std::exception&) {
+                    // Таблица заблокирована другим процессом или запись не удалась -
+                    // повтор через окно, строки остаются в группе
+                    deadline = now + std::max(window, std::chrono::milliseconds(1));
                 }
             }
+            wakeAt = waiting ? std::min(wakeAt, deadline) : deadline;
+            waiting = true;
+        }
+        
+        if (waiting) {
+            groupCommitWake.wait_until(lock, wakeAt);
+        } else {
+            groupCommitWake.wait(lock);
         }
     }
-    
-    return leftValue == rightValue;
 }
 
-bool Database::evaluateConditions(const std::vector<Condition>& conditions,
-                                   const std::map<std::string, std::vector<std::string>>& rowData,
-                                   const std::map<std::string, std::vector<std::string>>& tableHeaders) {
-    if (conditions.empty()) {
-        return true;
+TableStats& Database::getTableStats(const std::string& tableName) {
+    auto it = statsCache.find(tableName);
+    if (it != statsCache.end()) {
+        return it->second;
     }
     
-    bool result = evaluateCondition(conditions[0], rowData, tableHeaders);
-    
-    for (size_t i = 1; i < conditions.size(); ++i) {
-        bool condResult = evaluateCondition(conditions[i], rowData, tableHeaders);
-        
-        if (conditions[i-1].logicalOp == "AND") {
-            result = result && condResult;
-        } else if (conditions[i-1].logicalOp == "OR") {
-            result = result || condResult;
+    std::string tablePath = openTable(tableName);
+    TableStats stats;
+    if (!Statistics::load(tablePath, tableName, stats)) {
+        // Без ANALYZE число строк оценивается по чанкам: полные чанки и последний
+        auto files = FileManager::getCSVFiles(tablePath);
+        if (!files.empty()) {
+            stats.rowCount = static_cast<long long>(files.size() - 1) * config.tuples_limit +
+                             static_cast<long long>(FileManager::readChunk(files.back())->size());
         }
     }
     
-    return result;
+    return statsCache[tableName] = stats;
 }
 
-std::vector<std::vector<std::string>> Database::executeSelect(const SelectQuery& query) {
-    std::vector<std::vector<std::string>> result;
-    
+void Database::flushStatistics() {
+    for (const auto& tableName : dirtyStats) {
+        std::string tablePath = openTable(tableName);
+        Statistics::save(tablePath, tableName, statsCache[tableName]);
+    }
+    dirtyStats.clear();
+}
+
+void Database::saveStatistics(const std::string& tableName) {
+    Statistics::save(openTable(tableName), tableName, statsCache[tableName]);
+    dirtyStats.erase(tableName);
+}
+
+static bool sameColumn(const SelectColumn& a, const SelectColumn& b) {
+    return a.tableName == b.tableName && a.columnName == b.columnName &&
+           a.aggregate == b.aggregate && a.isStar == b.isStar;
+}
+
+// Тип значения колонки результата (для агрегатов - тип результата функции)
+ColumnType Database::getOutputType(const SelectColumn& column) {
+    ColumnType argType = column.isStar ? ColumnType::STRING
+                                       : config.getColumnType(column.tableName, column.columnName);
+    switch (column.aggregate) {
+        case AggregateFunc::COUNT:
+            return ColumnType::INT64;
+        case AggregateFunc::SUM:
+            return argType == ColumnType::INT64 ? ColumnType::INT64 : ColumnType::DOUBLE;
+        case AggregateFunc::AVG:
+            return ColumnType::DOUBLE;
+        default:
+            return argType;
+    }
+}
+
+void Database::executeSelect(const SelectQuery& query, const RowConsumer& consumer) {
     if (query.tables.empty()) {
-        return result;
-    }
-    
-    // Получение заголовков для всех таблиц
-    std::map<std::string, std::vector<std::string>> tableHeaders;
-    std::map<std::string, std::string> tablePaths;
-    
-    for (const auto& tableName : query.tables) {
-        std::string tablePath = FileManager::getTablePath(schemaName, tableName);
-        tablePaths[tableName] = tablePath;
-        tableHeaders[tableName] = getTableHeader(tablePath, tableName);
-    }
-    
-    // Рекурсивная функция для генерации декартова произведения
-    std::function<void(size_t, std::map<std::string, std::vector<std::string>>)> 
-        generateProduct = [&](size_t tableIndex, 
-                              std::map<std::string, std::vector<std::string>> currentRows) {
-        if (tableIndex >= query.tables.size()) {
-            // Проверка условий
-            if (evaluateConditions(query.conditions, currentRows, tableHeaders)) {
-                // Построение результирующей строки
-                std::vector<std::string> resultRow;
-                for (const auto& col : query.columns) {
-                    if (currentRows.find(col.tableName) != currentRows.end() &&
-                        tableHeaders.find(col.tableName) != tableHeaders.end()) {
-                        const auto& row = currentRows[col.tableName];
-                        const auto& header = tableHeaders[col.tableName];
-                        
-                        auto it = std::find(header.begin(), header.end(), col.columnName);
-                        if (it != header.end()) {
-                            size_t index = std::distance(header.begin(), it);
-                            if (index < row.size()) {
-                                resultRow.push_back(row[index]);
-                            } else {
-                                resultRow.push_back("");
-                            }
-                        } else {
-                            resultRow.push_back("");
-                        }
-                    } else {
-                        resultRow.push_back("");
+        return;
+    }
+    if (query.tables.size() > 64) {
+        throw std::runtime_error("Too many tables in FROM");
+    }
+    
+    validateConditions(query.conditions);
+    
+    // Получение заголовков, типов колонок и статистики для всех таблиц
+    size_t tableCount = query.tables.size();
+    std::vector<std::string> tablePaths(tableCount);
+    std::vector<std::vector<std::string>> headers(tableCount);
+    std::vector<std::vector<ColumnType>> types(tableCount);
+    std::vector<TableStats> stats(tableCount);
+    
+    for (size_t t = 0; t < tableCount; ++t) {
+        tablePaths[t] = openTable(query.tables[t]);
+        commitPendingRows(query.tables[t], false);
+        headers[t] = getTableHeader(tablePaths[t], query.tables[t]);
+        types[t] = getTableTypes(query.tables[t], headers[t]);
+        stats[t] = getTableStats(query.tables[t]);
+    }
+    
+    // Колонки, упомянутые в запросе: при сканировании разбираются только они
+    // (таблица, указанная в FROM несколько раз, читается с общей маской)
+    std::vector<ColumnMask> columnMasks(tableCount);
+    for (size_t t = 0; t < tableCount; ++t) {
+        columnMasks[t].assign(headers[t].size(), false);
+    }
+    auto useColumn = [&](const std::string& tableName, const std::string& columnName) {
+        for (size_t t = 0; t < tableCount; ++t) {
+            if (query.tables[t] != tableName) continue;
+            auto it = std::find(headers[t].begin(), headers[t].end(), columnName);
+            if (it != headers[t].end()) {
+                columnMasks[t][std::distance(headers[t].begin(), it)] = true;
+            }
+        }
+    };
+    for (const auto& col : query.columns) {
+        if (!col.isStar) useColumn(col.tableName, col.columnName);
+    }
+    for (const auto& col : query.groupBy) {
+        useColumn(col.tableName, col.columnName);
+    }
+    for (const auto& key : query.orderBy) {
+        useColumn(key.column.tableName, key.column.columnName);
+    }
+    for (const auto& cond : query.conditions) {
+        useColumn(cond.leftTable, cond.leftColumn);
+        if (!cond.isLiteral) useColumn(cond.rightTable, cond.rightColumn);
+    }
+    
+    auto bindColumn = [&](const SelectColumn& col) {
+        return resolveColumn(col.tableName, col.columnName, query.tables, headers);
+    };
+    std::vector<ColumnRef> outputRefs;
+    for (const auto& col : query.columns) {
+        outputRefs.push_back(bindColumn(col));
+    }
+    
+    // Подготовка хэш-агрегации: типы аргументов и соответствие колонок GROUP BY
+    bool aggregate = query.hasAggregates();
+    std::vector<ColumnType> argTypes;
+    std::vector<int> outputGroupIndex;
+    std::vector<ColumnRef> groupRefs;
+    if (aggregate) {
+        for (const auto& col : query.columns) {
+            argTypes.push_back(col.isStar ? ColumnType::STRING
+                                          : config.getColumnType(col.tableName, col.columnName));
+            
+            int groupIndex = -1;
+            if (col.aggregate == AggregateFunc::NONE) {
+                for (size_t i = 0; i < query.groupBy.size(); ++i) {
+                    if (query.groupBy[i].tableName == col.tableName &&
+                        query.groupBy[i].columnName == col.columnName) {
+                        groupIndex = static_cast<int>(i);
+                        break;
+                    }
+                }
+                if (groupIndex < 0) {
+                    throw std::runtime_error("Column " + col.tableName + "." + col.columnName +
+                                             " must appear in GROUP BY");
+                }
+            }
+            outputGroupIndex.push_back(groupIndex);
+        }
+        for (const auto& col : query.groupBy) {
+            groupRefs.push_back(bindColumn(col));
+        }
+    }
+    // Память запроса освобождается целиком при выходе из executeSelect;
+    // промежуточные результаты сверх query_memory_limit сбрасываются на диск
+    MemoryBudget budget(config.query_memory_limit);
+    QueryArena arena;
+    
+    // Итоговые агрегаты живут в своей арене: при нехватке памяти группы
+    // записываются в разделы на диске, а агрегатор создается заново
+    auto aggregateArena = std::make_unique<QueryArena>();
+    auto aggregator = std::make_unique<HashAggregator>(query.columns, argTypes, outputGroupIndex, *aggregateArena);
+    std::vector<std::unique_ptr<SpillFile>> aggregatePartitions;
+    size_t aggregateBytes = 0;
+    
+    auto resetAggregator = [&]() {
+        budget.release(aggregateBytes);
+        aggregateBytes = 0;
+        aggregator.reset();
+        aggregateArena = std::make_unique<QueryArena>();
+        aggregator = std::make_unique<HashAggregator>(query.columns, argTypes, outputGroupIndex, *aggregateArena);
+    };
+    auto spillAggregates = [&]() {
+        if (aggregatePartitions.empty()) {
+            for (size_t p = 0; p < AGGREGATE_PARTITIONS; ++p) {
+                aggregatePartitions.push_back(std::make_unique<SpillFile>(budget.spillBufferSize()));
+            }
+        }
+        aggregator->spill(aggregatePartitions);
+        resetAggregator();
+    };
+    
+    // Подготовка ORDER BY: ключ ссылается на колонку результата или на скрытую
+    // колонку, добавляемую в конец строки на время сортировки
+    std::vector<SortKey> sortKeys;
+    std::vector<ColumnRef> hiddenRefs;
+    for (const auto& orderCol : query.orderBy) {
+        const SelectColumn& key = orderCol.column;
+        size_t index = query.columns.size() + hiddenRefs.size();
+        auto it = std::find_if(query.columns.begin(), query.columns.end(),
+                               [&](const SelectColumn& col) { return sameColumn(col, key); });
+        if (it != query.columns.end()) {
+            index = std::distance(query.columns.begin(), it);
+        } else if (aggregate || key.aggregate != AggregateFunc::NONE) {
+            throw std::runtime_error("ORDER BY " + key.tableName + "." + key.columnName +
+                                     " must appear in the select list");
+        } else {
+            hiddenRefs.push_back(bindColumn(key));
+        }
+        sortKeys.push_back(SortKey{index, getOutputType(key), orderCol.descending});
+    }
+    
+    // ORDER BY <таблица>_pk совпадает с порядком чанков и строк в них, если эта
+    // таблица сканируется внешней и ANALYZE отметил первичный ключ упорядоченным
+    // (ключи, выданные разными процессами, могли чередоваться)
+    int pkOrderTable = -1;
+    if (!aggregate && !query.orderBy.empty() && !query.orderBy[0].descending &&
+        (query.orderBy.size() == 1 || tableCount == 1)) {
+        const SelectColumn& key = query.orderBy[0].column;
+        ColumnRef ref = bindColumn(key);
+        if (key.aggregate == AggregateFunc::NONE && ref.table >= 0 &&
+            key.columnName == key.tableName + "_pk" && stats[ref.table].isSorted(key.columnName)) {
+            pkOrderTable = ref.table;
+        }
+    }
+    
+    // Планирование: с LIMIT внешней выбирается таблица из ORDER BY, чтобы не сортировать
+    Predicate where = Predicate::fromConditions(query.conditions);
+    where.bind(query.tables, headers, types);
+    QueryPlan plan = Planner::plan(where, headers, types, stats, query.limit >= 0 ? pkOrderTable : -1);
+    
+    // Сколько строк нужно выдать с учетом OFFSET (-1 - все)
+    long long rowsNeeded = query.limit < 0 ? -1 : query.offset + query.limit;
+    RowSorter sorter(sortKeys, aggregate ? -1 : rowsNeeded, &budget);
+    std::atomic<bool> stop{query.limit == 0 && !aggregate};
+    
+    // Выдача строк результата с учетом OFFSET и LIMIT; false - строк больше не нужно
+    long long skipped = 0;
+    long long emitted = 0;
+    RowConsumer output = [&](std::vector<std::string>& row) {
+        if (skipped < query.offset) {
+            skipped++;
+            return true;
+        }
+        if (query.limit >= 0 && emitted >= query.limit) {
+            return false;
+        }
+        emitted++;
+        return consumer(row) && (query.limit < 0 || emitted < query.limit);
+    };
+    
+    // Построение сторон build для всех уровней, кроме внешнего. Стороны строятся
+    // с последнего уровня: фильтр Блума по ключам уровня k применяется при
+    // сканировании таблицы более раннего уровня, с которой уровень k соединяется.
+    // Сторона, не поместившаяся в бюджет памяти, строится частями, и для каждой
+    // части внешняя таблица сканируется заново
+    std::vector<std::vector<std::string>> levelFiles(plan.levels.size());
+    std::vector<int> levelOfTable(tableCount, -1);
+    for (size_t k = 0; k < plan.levels.size(); ++k) {
+        levelFiles[k] = FileManager::getCSVFiles(tablePaths[plan.levels[k].table]);
+        levelOfTable[plan.levels[k].table] = static_cast<int>(k);
+    }
+    std::vector<std::unique_ptr<BuildSide>> buildSides(plan.levels.size());
+    std::vector<std::unique_ptr<SemiJoinFilter>> semiJoinFilters;
+    std::vector<std::vector<const SemiJoinFilter*>> scanSemiJoins(plan.levels.size());
+    int slicedLevel = -1;
+    size_t sliceEnd = 0; // Первый чанк следующей части
+    
+    std::string keyBuffer;
+    // Сторона уровня k из чанков, начиная с firstFile; возвращает индекс первого
+    // непрочитанного чанка (при canSlice чтение прекращается при превышении бюджета)
+    auto buildLevel = [&](size_t k, size_t firstFile, bool canSlice) {
+        const PlanLevel& level = plan.levels[k];
+        buildSides[k] = std::make_unique<BuildSide>(budget);
+        BuildSide& side = *buildSides[k];
+        bool hashed = level.probeKey.table >= 0;
+        
+        size_t nextFile = firstFile;
+        ChunkReader reader(std::vector<std::string>(levelFiles[k].begin() + firstFile, levelFiles[k].end()),
+                           config.read_ahead, columnMasks[level.table]);
+        std::shared_ptr<const CSVRows> rows;
+        while (reader.next(rows)) {
+            nextFile++;
+            SelectionVector selection = BatchFilter::filter(*rows, level.scanFilter);
+            applySemiJoinFilters(*rows, scanSemiJoins[k], selection, keyBuffer);
+            if (selection.empty()) {
+                continue;
+            }
+            side.chunks.push_back(rows);
+            size_t bytes = BufferPool::estimateBytes(*rows) + selection.size() * sizeof(const void*);
+            for (uint32_t rowIndex : selection) {
+                const auto* row = &(*rows)[rowIndex];
+                if (hashed) {
+                    const std::string& value = cellValue(*row, level.buildKey.column);
+                    if (!isJoinable(value, level.keyType)) {
+                        continue;
+                    }
+                    std::string_view key = joinKey(value, level.keyType, keyBuffer);
+                    auto it = side.hashTable.find(key);
+                    if (it == side.hashTable.end()) {
+                        it = side.hashTable.emplace(side.arena.intern(key),
+                                                    BuildSide::RowList(side.arena.resource())).first;
+                        bytes += key.size() + HASH_ENTRY_OVERHEAD;
                     }
+                    it->second.push_back(row);
+                } else {
+                    side.rows.push_back(row);
                 }
-                result.push_back(resultRow);
             }
+            side.reserve(bytes);
+            
+            if (canSlice && budget.exceeded()) {
+                break;
+            }
+        }
+        return nextFile;
+    };
+    
+    for (size_t k = plan.levels.size() - 1; k >= 1 && !stop; --k) {
+        const PlanLevel& level = plan.levels[k];
+        if (level.mergeJoin) {
+            continue; // Читается потоково вместе с внешней таблицей
+        }
+        
+        size_t nextFile = buildLevel(k, 0, slicedLevel < 0);
+        if (nextFile < levelFiles[k].size()) {
+            slicedLevel = static_cast<int>(k);
+            sliceEnd = nextFile;
+            continue; // Ключи части неполны, фильтр Блума по ним строить нельзя
+        }
+        
+        if (level.probeKey.table >= 0) {
+            const BuildSide& side = *buildSides[k];
+            auto filter = std::make_unique<SemiJoinFilter>(
+                SemiJoinFilter{level.probeKey.column, level.keyType, BloomFilter(side.hashTable.size())});
+            for (const auto& [key, keyRows] : side.hashTable) {
+                filter->bloom.add(key);
+            }
+            scanSemiJoins[levelOfTable[level.probeKey.table]].push_back(filter.get());
+            semiJoinFilters.push_back(std::move(filter));
+        }
+    }
+    
+    // При нескольких проходах по внешней таблице строки выдаются не в порядке первичного ключа
+    bool naturalOrder = pkOrderTable >= 0 && plan.levels[0].table == pkOrderTable && slicedLevel < 0;
+    bool sortRows = !query.orderBy.empty() && !naturalOrder;
+    
+    // Вторая таблица соединения слиянием (потоковая, без хэш-таблицы)
+    std::unique_ptr<MergeCursor> mergeCursor;
+    
+    // Строка результата: в сортировку или сразу получателю. Без сортировки строки
+    // выдаются в порядке сканирования, сканирование прекращается, как только
+    // набрано OFFSET + LIMIT строк
+    auto deliver = [&](std::vector<std::string>& row) {
+        if (sortRows) {
+            sorter.add(std::move(row));
+        } else if (!output(row)) {
+            stop = true;
+        }
+    };
+    
+    // Обработка кортежа, прошедшего все условия
+    auto emitTuple = [&](ProbeContext& context) {
+        const Tuple& tuple = context.tuple;
+        if (aggregate) {
+            // Строка не материализуется, а сразу учитывается в агрегатах
+            for (size_t i = 0; i < groupRefs.size(); ++i) {
+                context.groupKey[i] = &tupleValue(tuple, groupRefs[i]);
+            }
+            for (size_t i = 0; i < query.columns.size(); ++i) {
+                const auto& col = query.columns[i];
+                context.aggregateArgs[i] = col.aggregate == AggregateFunc::NONE || col.isStar
+                                               ? nullptr
+                                               : &tupleValue(tuple, outputRefs[i]);
+            }
+            context.aggregator->add(context.groupKey, context.aggregateArgs);
             return;
         }
         
-        // Обработка текущей таблицы
-        std::string tableName = query.tables[tableIndex];
-        std::string tablePath = tablePaths[tableName];
-        auto files = FileManager::getCSVFiles(tablePath);
+        // Построение результирующей строки
+        std::vector<std::string> resultRow;
+        resultRow.reserve(outputRefs.size() + hiddenRefs.size());
+        for (const auto& ref : outputRefs) {
+            resultRow.push_back(tupleValue(tuple, ref));
+        }
+        if (sortRows) {
+            for (const auto& ref : hiddenRefs) {
+                resultRow.push_back(tupleValue(tuple, ref));
+            }
+        }
         
-        for (const auto& file : files) {
-            auto rows = FileManager::readCSVFile(file);
-            for (const auto& row : rows) {
-                std::map<std::string, std::vector<std::string>> newRows = currentRows;
-                newRows[tableName] = row;
-                generateProduct(tableIndex + 1, newRows);
+        if (context.rows != nullptr) {
+            context.rows->push_back(std::move(resultRow));
+        } else {
+            deliver(resultRow);
+        }
+    };
+    
+    // Уровни соединения: поиск в хэш-таблице по ключу, слияние или перебор строк build
+    std::function<void(ProbeContext&, size_t)> probeLevel = [&](ProbeContext& context, size_t k) {
+        if (k == plan.levels.size()) {
+            emitTuple(context);
+            return;
+        }
+        
+        Tuple& tuple = context.tuple;
+        const PlanLevel& level = plan.levels[k];
+        const BuildSide::RowList* candidates = nullptr;
+        
+        if (level.mergeJoin) {
+            candidates = &mergeCursor->seek(tupleValue(tuple, level.probeKey));
+        } else if (level.probeKey.table >= 0) {
+            const BuildSide& side = *buildSides[k];
+            auto it = side.hashTable.find(joinKey(tupleValue(tuple, level.probeKey), level.keyType,
+                                                  context.keyBuffer));
+            if (it == side.hashTable.end()) {
+                return;
             }
+            candidates = &it->second;
+        } else {
+            candidates = &buildSides[k]->rows;
         }
+        
+        for (const auto* row : *candidates) {
+            if (stop) {
+                return;
+            }
+            tuple[level.table] = row;
+            if (level.joinFilter.evaluate(tuple)) {
+                probeLevel(context, k + 1);
+            }
+        }
+        tuple[level.table] = nullptr;
     };
     
-    generateProduct(0, {});
+    // Обработка чанка внешней таблицы (сторона probe). Частичные агрегаты считаются
+    // по чанку в своей арене, которая освобождается после слияния с итоговыми
+    const PlanLevel& outer = plan.levels[0];
+    std::mutex resultMutex; // Итоговые агрегаты
+    auto processChunk = [&](ProbeContext& context, const CSVRows& rows) {
+        SelectionVector selection = BatchFilter::filter(rows, outer.scanFilter);
+        applySemiJoinFilters(rows, scanSemiJoins[0], selection, context.keyBuffer);
+        
+        QueryArena chunkArena;
+        HashAggregator chunkAggregator(query.columns, argTypes, outputGroupIndex, chunkArena);
+        context.aggregator = &chunkAggregator;
+        
+        for (uint32_t rowIndex : selection) {
+            if (stop) {
+                break;
+            }
+            context.tuple[outer.table] = &rows[rowIndex];
+            if (outer.joinFilter.evaluate(context.tuple)) {
+                probeLevel(context, 1);
+            }
+        }
+        context.aggregator = nullptr;
+        
+        if (aggregate) {
+            std::lock_guard<std::mutex> guard(resultMutex);
+            aggregator->merge(chunkAggregator);
+            size_t used = aggregator->memoryUsage();
+            budget.reserve(used - aggregateBytes);
+            aggregateBytes = used;
+            // Без GROUP BY группа одна, сбрасывать нечего; группы копятся до своей
+            // доли бюджета, даже если его держит превышенным сторона соединения
+            if (budget.shouldSpill(aggregateBytes) && !query.groupBy.empty()) {
+                spillAggregates();
+            }
+        }
+    };
+    
+    // Последовательное сканирование: соединение слиянием читает вторую таблицу
+    // синхронно с внешней, а при LIMIT без сортировки сканирование прекращается досрочно
+    bool parallelScan = levelFiles[0].size() > 1 && ThreadPool::instance().size() > 1 &&
+                        !(plan.levels.size() > 1 && plan.levels[1].mergeJoin) &&
+                        !(query.limit >= 0 && !sortRows && !aggregate);
     
+    auto scanOuter = [&]() {
+        if (plan.levels.size() > 1 && plan.levels[1].mergeJoin && !stop) {
+            mergeCursor = std::make_unique<MergeCursor>(levelFiles[1], config.read_ahead,
+                                                        columnMasks[plan.levels[1].table], plan.levels[1],
+                                                        scanSemiJoins[1], arena.resource());
+        }
+        
+        ProbeContext context(tableCount, query.groupBy.size(), query.columns.size());
+        ChunkReader outerReader(levelFiles[0], config.read_ahead, columnMasks[plan.levels[0].table]);
+        std::shared_ptr<const CSVRows> rows;
+        while (!stop && outerReader.next(rows)) {
+            processChunk(context, *rows);
+        }
+        mergeCursor.reset();
+    };
+    
+    // Параллельное сканирование по морселам: морсел - один чанк внешней таблицы.
+    // Потоки пула забирают следующий морсел (быстрый поток берет больше морселов),
+    // читают его сами и проверяют строки по общим неизменяемым хэш-таблицам.
+    // Строки морсела копятся в потоке и выдаются получателю в вызывающем потоке
+    // в порядке морселов, поэтому результат совпадает с последовательным.
+    // Готовые невыданные строки учитываются в бюджете памяти, а новый морсел берется,
+    // только пока обрабатываемых и ждущих выдачи морселов не больше окна
+    auto scanOuterParallel = [&]() {
+        const auto& files = levelFiles[0];
+        size_t threadCount = std::min(ThreadPool::instance().size(), files.size());
+        size_t window = MORSEL_WINDOW_PER_THREAD * threadCount;
+        
+        struct FinishedMorsel {
+            std::vector<std::vector<std::string>> rows;
+            size_t bytes = 0; // Зарезервировано в бюджете до выдачи
+        };
+        std::mutex morselMutex;
+        std::condition_variable morselReady;  // Морсел обработан или поток завершился
+        std::condition_variable morselTaken;  // Морсел выдан или сканирование прервано
+        std::map<size_t, FinishedMorsel> finishedMorsels;
+        size_t claimedMorsels = 0;
+        size_t deliveredMorsels = 0;
+        size_t finishedWorkers = 0;
+        std::exception_ptr error;
+        
+        auto claim = [&](size_t& morsel) {
+            std::unique_lock<std::mutex> lock(morselMutex);
+            // При агрегации строки не выдаются, и окно не нужно
+            morselTaken.wait(lock, [&] {
+                return stop || aggregate || claimedMorsels < deliveredMorsels + window;
+            });
+            if (stop || claimedMorsels >= files.size()) {
+                return false;
+            }
+            morsel = claimedMorsels++;
+            return true;
+        };
+        
+        auto worker = [&]() {
+            ProbeContext context(tableCount, query.groupBy.size(), query.columns.size());
+            std::vector<std::vector<std::string>> morselRows;
+            context.rows = &morselRows;
+            
+            size_t morsel;
+            while (claim(morsel)) {
+                // Чтение без упреждения: задачи упреждения стояли бы в той же очереди пула
+                std::shared_ptr<const CSVRows> rows = FileManager::readChunk(files[morsel],
+                                                                             columnMasks[plan.levels[0].table]);
+                processChunk(context, *rows);
+                if (aggregate) {
+                    continue;
+                }
+                
+                FinishedMorsel finished;
+                for (const auto& row : morselRows) {
+                    finished.bytes += BufferPool::estimateRowBytes(row);
+                }
+                finished.rows = std::move(morselRows);
+                morselRows.clear();
+                budget.reserve(finished.bytes);
+                {
+                    std::lock_guard<std::mutex> guard(morselMutex);
+                    finishedMorsels.emplace(morsel, std::move(finished));
+                }
+                morselReady.notify_all();
+            }
+        };
+        
+        auto runWorker = [&]() {
+            try {
+                worker();
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(morselMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                stop = true;
+            }
+            {
+                std::lock_guard<std::mutex> guard(morselMutex);
+                finishedWorkers++;
+            }
+            morselReady.notify_all();
+            morselTaken.notify_all();
+        };
+        
+        // Выдача морселов по порядку; строки передаются получателю вне блокировки
+        auto deliverMorsels = [&](size_t workerCount) {
+            std::unique_lock<std::mutex> lock(morselMutex);
+            while (!stop && deliveredMorsels < files.size()) {
+                morselReady.wait(lock, [&] {
+                    return stop || finishedWorkers == workerCount || finishedMorsels.count(deliveredMorsels) > 0;
+                });
+                auto it = finishedMorsels.find(deliveredMorsels);
+                if (stop || it == finishedMorsels.end()) {
+                    break;
+                }
+                FinishedMorsel finished = std::move(it->second);
+                finishedMorsels.erase(it);
+                lock.unlock();
+                
+                for (auto& row : finished.rows) {
+                    if (stop) {
+                        break;
+                    }
+                    deliver(row);
+                }
+                budget.release(finished.bytes);
+                
+                lock.lock();
+                deliveredMorsels++;
+                morselTaken.notify_all();
+            }
+        };
+        
+        // При агрегации вызывающий поток тоже обрабатывает морселы, иначе он
+        // выдает строки. До выхода дожидаемся всех задач, так как они ссылаются
+        // на состояние запроса
+        size_t workerCount = aggregate ? threadCount - 1 : threadCount;
+        std::vector<std::future<void>> tasks;
+        for (size_t i = 0; i < workerCount; ++i) {
+            tasks.push_back(ThreadPool::instance().submit(runWorker));
+        }
+        
+        if (aggregate) {
+            runWorker();
+        } else {
+            try {
+                deliverMorsels(workerCount);
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(morselMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                stop = true;
+            }
+            // Потоки, ждущие окна, должны увидеть остановку
+            {
+                std::lock_guard<std::mutex> guard(morselMutex);
+            }
+            morselTaken.notify_all();
+        }
+        for (auto& task : tasks) {
+            task.get();
+        }
+        
+        for (const auto& [morsel, finished] : finishedMorsels) {
+            budget.release(finished.bytes);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    };
+    
+    auto runPass = [&]() {
+        if (parallelScan) {
+            scanOuterParallel();
+        } else {
+            scanOuter();
+        }
+    };
+    
+    runPass();
+    while (slicedLevel >= 0 && sliceEnd < levelFiles[slicedLevel].size() && !stop) {
+        buildSides[slicedLevel].reset();
+        sliceEnd = buildLevel(slicedLevel, sliceEnd, true);
+        runPass();
+    }
+    
+    if (aggregate) {
+        RowSorter groupSorter(sortKeys, rowsNeeded, &budget);
+        bool done = false;
+        RowConsumer groupOutput = [&](std::vector<std::string>& row) {
+            if (!query.orderBy.empty()) {
+                groupSorter.add(std::move(row));
+                return true;
+            }
+            done = !output(row);
+            return !done;
+        };
+        
+        if (aggregatePartitions.empty()) {
+            aggregator->finish(!query.groupBy.empty(), groupOutput);
+        } else {
+            // Группы из памяти дописываются в разделы, затем каждый раздел
+            // агрегируется отдельно: группа целиком попадает в один раздел
+            spillAggregates();
+            for (auto& partition : aggregatePartitions) {
+                if (done) {
+                    break;
+                }
+                partition->rewind();
+                std::vector<std::string> record;
+                while (partition->read(record)) {
+                    aggregator->addSpilled(record);
+                }
+                aggregator->finish(true, groupOutput);
+                partition.reset();
+                resetAggregator();
+            }
+        }
+        
+        if (!query.orderBy.empty()) {
+            groupSorter.finish(output);
+        }
+    } else if (sortRows) {
+        sorter.finish([&](std::vector<std::string>& row) {
+            row.resize(query.columns.size()); // Удаление скрытых колонок
+            return output(row);
+        });
+    }
+}
+
+std::vector<std::vector<std::string>> Database::executeSelect(const SelectQuery& query) {
+    std::vector<std::vector<std::string>> result;
+    executeSelect(query, [&result](std::vector<std::string>& row) {
+        result.push_back(std::move(row));
+        return true;
+    });
     return result;
 }
 
-void Database::executeInsert(const InsertQuery& query) {
-    std::string tablePath = FileManager::getTablePath(schemaName, query.tableName);
+void Database::executeInsert(const InsertQuery& query, std::unique_lock<std::mutex>& statement) {
+    std::string tablePath = openTable(query.tableName);
+    TableWriter::GroupRow groupRow;
     
     // Блокировка таблицы
     if (!FileManager::lockTable(tablePath, query.tableName)) {
@@ -185,15 +1137,9 @@ void Database::executeInsert(const InsertQuery& query) {
     }
     
     try {
-        // Получение следующего первичного ключа
-        int nextPK = FileManager::readPKSequence(tablePath, query.tableName) + 1;
-        
-        // Получение структуры таблицы
-        auto header = getTableHeader(tablePath, query.tableName);
-        if (header.empty()) {
-            FileManager::unlockTable(tablePath, query.tableName);
-            throw std::runtime_error("Cannot read table structure");
-        }
+        // Структура таблицы запоминается при открытии дескриптора дозаписи
+        TableWriter& writer = getTableWriter(query.tableName, tablePath);
+        const auto& header = writer.getHeader();
         
         // Подсчет колонок данных (исключая первичный ключ)
         size_t dataColumnCount = header.size() - 1;
@@ -202,47 +1148,154 @@ void Database::executeInsert(const InsertQuery& query) {
             throw std::runtime_error("Column count mismatch");
         }
         
-        // Поиск файла для вставки
-        auto files = FileManager::getCSVFiles(tablePath);
-        std::string targetFile;
+        // Проверка значений типизированных колонок
+        for (size_t i = 0; i < query.values.size(); ++i) {
+            ColumnType type = config.getColumnType(query.tableName, header[i + 1]);
+            if (!ColumnTypes::isValid(query.values[i], type)) {
+                throw std::runtime_error("Invalid " + ColumnTypes::typeName(type) + " value '" +
+                                         query.values[i] + "' for column " + header[i + 1]);
+            }
+        }
         
-        if (files.empty()) {
-            targetFile = tablePath + "/1.csv";
-        } else {
-            // Проверка последнего файла
-            std::string lastFile = files.back();
-            int rowCount = FileManager::getRowCount(lastFile);
-            
-            if (rowCount < config.tuples_limit) {
-                targetFile = lastFile;
+        // Снятый флаг упорядоченности сохраняется до записи строки: после сбоя
+        // соединение слиянием не должно доверять флагу из файла статистики
+        TableStats& stats = getTableStats(query.tableName);
+        if (stats.analyzed && keepPKOrder(stats, query.tableName)) {
+            saveStatistics(query.tableName);
+        }
+        
+        // Строка попадает в группу, которая записывается по окну group_commit_ms;
+        // первичный ключ строка получает при записи группы.
+        // При flush и fsync группа записывается сразу, если добавить в нее строки
+        // больше некому: остальные выполняющиеся запросы (если есть) ждут записи групп
+        groupRow = writer.append(query.values);
+        bool joinable = activeStatements > groupWaiters + 1;
+        if (writer.due(std::chrono::milliseconds(config.group_commit_ms)) ||
+            (config.durability != Durability::NONE && !joinable)) {
+            writer.commit(config.durability, getPKSequence(query.tableName));
+            groupCommitted.notify_all();
+        } else if (writer.pendingRows() == 1) {
+            // Новая группа: фоновый поток запишет ее по истечении окна
+            if (!groupCommitThread.joinable()) {
+                groupCommitThread = std::thread(&Database::groupCommitLoop, this);
+            }
+            groupCommitWake.notify_one();
+        }
+        
+        stats.rowCount++;
+        if (stats.analyzed) {
+            stats.distinctCounts[query.tableName + "_pk"] = stats.rowCount;
+            dirtyStats.insert(query.tableName);
+        }
+        
+    } catch (...) {
+        FileManager::unlockTable(tablePath, query.tableName);
+        throw;
+    }
+    
+    // Разблокировка таблицы
+    FileManager::unlockTable(tablePath, query.tableName);
+    
+    if (config.durability != Durability::NONE) {
+        waitForGroup(query.tableName, groupRow, statement);
+    }
+}
+
+void Database::waitForGroup(const std::string& tableName, const TableWriter::GroupRow& row,
+                            std::unique_lock<std::mutex>& statement) {
+    // Пока группа открыта, запрос ждет вне statementMutex, и другие запросы
+    // добавляют в нее строки; группу записывает тот, кто первым застанет ее
+    // истекшей или застанет все выполняющиеся запросы ждущими
+    groupWaiters++;
+    try {
+        while (!row.group->done) {
+            const TableWriter& writer = *tableWriters.at(tableName);
+            std::chrono::milliseconds window(config.group_commit_ms);
+            if (writer.due(window) || activeStatements <= groupWaiters) {
+                commitPendingRows(tableName, false);
             } else {
-                // Создание нового файла
-                int nextFileNum = FileManager::getNextFileNumber(tablePath);
-                targetFile = tablePath + "/" + std::to_string(nextFileNum) + ".csv";
-                
-                // Создание файла с заголовком
-                std::ofstream newFile(targetFile);
-                if (newFile.is_open()) {
-                    for (size_t i = 0; i < header.size(); ++i) {
-                        newFile << header[i];
-                        if (i < header.size() - 1) newFile << ",";
-                    }
-                    newFile << "\n";
-                    newFile.close();
-                }
+                groupCommitted.wait_until(statement, writer.deadline(window));
             }
         }
+    } catch (...) {
+        // Неудачная запись при flush и fsync отбрасывает группу - ошибка
+        // сообщается ниже каждой ее незаписанной строке
+        if (!row.group->done) {
+            groupWaiters--;
+            throw;
+        }
+    }
+    groupWaiters--;
+    
+    if (!row.written()) {
+        throw std::runtime_error(row.group->error);
+    }
+}
+
+long long Database::executeDelete(const DeleteQuery& query) {
+    std::string tablePath = openTable(query.tableName);
+    
+    validateConditions(query.conditions);
+    
+    // Блокировка таблицы
+    if (!FileManager::lockTable(tablePath, query.tableName)) {
+        throw std::runtime_error("Table " + query.tableName + " is locked");
+    }
+    
+    long long deletedCount = 0;
+    try {
+        commitPendingRows(query.tableName, true);
+        auto header = getTableHeader(tablePath, query.tableName);
+        if (header.empty()) {
+            FileManager::unlockTable(tablePath, query.tableName);
+            return 0;
+        }
         
-        // Построение строки: первичный ключ + значения
-        std::vector<std::string> row;
-        row.push_back(std::to_string(nextPK));
-        row.insert(row.end(), query.values.begin(), query.values.end());
+        std::vector<std::string> tables{query.tableName};
+        std::vector<std::vector<std::string>> headers{header};
+        std::vector<std::vector<ColumnType>> types{getTableTypes(query.tableName, header)};
+        std::vector<TableStats> stats{getTableStats(query.tableName)};
         
-        // Добавление строки
-        FileManager::appendToCSVFile(targetFile, row);
+        // Условия DELETE относятся к одной таблице и целиком вычисляются пакетно
+        Predicate where = Predicate::fromConditions(query.conditions);
+        where.bind(tables, headers, types);
+        Planner::estimate(where, headers, stats);
         
-        // Обновление последовательности первичных ключей
-        FileManager::writePKSequence(tablePath, query.tableName, nextPK);
+        ChunkReader reader(FileManager::getCSVFiles(tablePath), config.read_ahead);
+        std::shared_ptr<const CSVRows> rows;
+        
+        while (reader.next(rows)) {
+            
+            // Строки из вектора выбора удаляются
+            SelectionVector deleted = BatchFilter::filter(*rows, where);
+            if (deleted.empty()) {
+                continue;
+            }
+            
+            // Оставшиеся строки не копируются: записываются прямо из чанка
+            std::vector<const std::vector<std::string>*> newRows;
+            newRows.reserve(rows->size() - deleted.size());
+            size_t next = 0;
+            for (uint32_t i = 0; i < rows->size(); ++i) {
+                if (next < deleted.size() && deleted[next] == i) {
+                    ++next;
+                    continue;
+                }
+                newRows.push_back(&(*rows)[i]);
+            }
+            deletedCount += deleted.size();
+            
+            // Перезапись файла
+            FileManager::writeCSVFile(reader.currentFile(), header, newRows);
+        }
+        
+        // Число строк в статистике поддерживается без повторного ANALYZE
+        TableStats& tableStats = getTableStats(query.tableName);
+        tableStats.rowCount = std::max(0LL, tableStats.rowCount - deletedCount);
+        if (tableStats.analyzed && deletedCount > 0) {
+            tableStats.distinctCounts[query.tableName + "_pk"] = tableStats.rowCount;
+            dirtyStats.insert(query.tableName);
+        }
         
     } catch (...) {
         FileManager::unlockTable(tablePath, query.tableName);
@@ -251,51 +1304,446 @@ void Database::executeInsert(const InsertQuery& query) {
     
     // Разблокировка таблицы
     FileManager::unlockTable(tablePath, query.tableName);
+    return deletedCount;
 }
 
-void Database::executeDelete(const DeleteQuery& query) {
-    std::string tablePath = FileManager::getTablePath(schemaName, query.tableName);
+long long Database::executeUpdate(const UpdateQuery& query) {
+    std::string tablePath = openTable(query.tableName);
+    
+    validateConditions(query.conditions);
     
     // Блокировка таблицы
     if (!FileManager::lockTable(tablePath, query.tableName)) {
         throw std::runtime_error("Table " + query.tableName + " is locked");
     }
     
+    long long updatedCount = 0;
     try {
+        commitPendingRows(query.tableName, true);
         auto header = getTableHeader(tablePath, query.tableName);
         if (header.empty()) {
             FileManager::unlockTable(tablePath, query.tableName);
-            return;
+            return 0;
+        }
+        
+        // Привязка присваиваний к колонкам; первичный ключ не изменяется
+        std::vector<std::pair<size_t, std::string>> assignments;
+        for (const auto& assignment : query.assignments) {
+            auto it = std::find(header.begin(), header.end(), assignment.columnName);
+            if (it == header.end()) {
+                throw std::runtime_error("Unknown column: " + query.tableName + "." + assignment.columnName);
+            }
+            if (it == header.begin()) {
+                throw std::runtime_error("Primary key " + assignment.columnName + " cannot be updated");
+            }
+            
+            ColumnType type = config.getColumnType(query.tableName, assignment.columnName);
+            if (!ColumnTypes::isValid(assignment.value, type)) {
+                throw std::runtime_error("Invalid " + ColumnTypes::typeName(type) + " value '" +
+                                         assignment.value + "' for column " + assignment.columnName);
+            }
+            assignments.emplace_back(std::distance(header.begin(), it), assignment.value);
+        }
+        
+        std::vector<std::string> tables{query.tableName};
+        std::vector<std::vector<std::string>> headers{header};
+        std::vector<std::vector<ColumnType>> types{getTableTypes(query.tableName, header)};
+        std::vector<TableStats> stats{getTableStats(query.tableName)};
+        
+        Predicate where = Predicate::fromConditions(query.conditions);
+        where.bind(tables, headers, types);
+        Planner::estimate(where, headers, stats);
+        
+        ChunkReader reader(FileManager::getCSVFiles(tablePath), config.read_ahead);
+        std::shared_ptr<const CSVRows> rows;
+        while (reader.next(rows)) {
+            
+            // Чанки без подходящих строк не перезаписываются
+            SelectionVector updated = BatchFilter::filter(*rows, where);
+            if (updated.empty()) {
+                continue;
+            }
+            
+            // Копируются только измененные строки, остальные записываются из чанка
+            std::vector<const std::vector<std::string>*> newRows;
+            newRows.reserve(rows->size());
+            for (const auto& row : *rows) {
+                newRows.push_back(&row);
+            }
+            std::vector<std::vector<std::string>> changedRows;
+            changedRows.reserve(updated.size());
+            for (uint32_t rowIndex : updated) {
+                changedRows.push_back((*rows)[rowIndex]);
+                auto& row = changedRows.back();
+                for (const auto& [column, value] : assignments) {
+                    if (column >= row.size()) {
+                        row.resize(column + 1);
+                    }
+                    row[column] = value;
+                }
+                newRows[rowIndex] = &row;
+            }
+            
+            // Измененные колонки больше не считаются упорядоченными; флаги
+            // сохраняются до замены первого чанка, чтобы пережить сбой
+            TableStats& tableStats = getTableStats(query.tableName);
+            if (updatedCount == 0 && tableStats.analyzed) {
+                size_t sortedCount = tableStats.sortedColumns.size();
+                for (const auto& [column, value] : assignments) {
+                    tableStats.sortedColumns.erase(header[column]);
+                }
+                if (tableStats.sortedColumns.size() != sortedCount) {
+                    saveStatistics(query.tableName);
+                }
+            }
+            
+            updatedCount += updated.size();
+            
+            // Атомарная замена чанка
+            FileManager::writeCSVFile(reader.currentFile(), header, newRows);
         }
         
-        std::map<std::string, std::vector<std::string>> tableHeaders;
-        tableHeaders[query.tableName] = header;
+    } catch (...) {
+        FileManager::unlockTable(tablePath, query.tableName);
+        throw;
+    }
+    
+    // Разблокировка таблицы
+    FileManager::unlockTable(tablePath, query.tableName);
+    return updatedCount;
+}
+
+// Имя колонки результата: "таблица.колонка" или "ФУНКЦИЯ(таблица.колонка)"
+static std::string columnLabel(const SelectColumn& column) {
+    std::string argument = column.isStar ? "*" : column.tableName + "." + column.columnName;
+    switch (column.aggregate) {
+        case AggregateFunc::COUNT: return "COUNT(" + argument + ")";
+        case AggregateFunc::SUM: return "SUM(" + argument + ")";
+        case AggregateFunc::MIN: return "MIN(" + argument + ")";
+        case AggregateFunc::MAX: return "MAX(" + argument + ")";
+        case AggregateFunc::AVG: return "AVG(" + argument + ")";
+        default: return argument;
+    }
+}
+
+ResultSet Database::execute(const std::string& sql) {
+    return execute(sql, nullptr);
+}
+
+ResultSet Database::execute(const std::string& sql, const RowConsumer& onRow) {
+    // Запрос считается выполняющимся и пока ждет очереди: он может добавить строки в группу
+    activeStatements++;
+    std::unique_lock<std::mutex> statement(statementMutex);
+    struct StatementEnd {
+        Database& db;
+        ~StatementEnd() {
+            // Под statementMutex: ждущие группу INSERT не пропустят пробуждение
+            db.activeStatements--;
+            db.groupCommitted.notify_all();
+        }
+    } statementEnd{*this};
+    
+    QueryType type = SQLParser::parseQueryType(sql);
+    switch (type) {
+        case QueryType::SELECT: {
+            SelectQuery query = SQLParser::parseSelect(sql);
+            std::vector<std::string> names;
+            std::vector<ColumnType> types;
+            for (const auto& column : query.columns) {
+                names.push_back(columnLabel(column));
+                types.push_back(getOutputType(column));
+            }
+            if (!onRow) {
+                return ResultSet(std::move(names), std::move(types), executeSelect(query));
+            }
+            
+            // Строки передаются получателю по мере готовности и не накапливаются
+            long long rowCount = 0;
+            executeSelect(query, [&](std::vector<std::string>& row) {
+                rowCount++;
+                return onRow(row);
+            });
+            return ResultSet(std::move(names), std::move(types), rowCount);
+        }
+        case QueryType::INSERT:
+            executeInsert(SQLParser::parseInsert(sql), statement);
+            return ResultSet(type, 1);
+        case QueryType::DELETE:
+            return ResultSet(type, executeDelete(SQLParser::parseDelete(sql)));
+        case QueryType::UPDATE:
+            return ResultSet(type, executeUpdate(SQLParser::parseUpdate(sql)));
+        case QueryType::COPY:
+            return ResultSet(type, executeCopy(SQLParser::parseCopy(sql)));
+        case QueryType::ANALYZE:
+            executeAnalyze(SQLParser::parseAnalyze(sql));
+            return ResultSet(type, 0);
+        case QueryType::SET:
+            executeSet(SQLParser::parseSet(sql));
+            return ResultSet(type, 0);
+        default:
+            throw std::runtime_error("Unknown query type");
+    }
+}
+
+// Настройки сеанса меняют копию конфигурации этого экземпляра Database, schema.json не изменяется
+void Database::executeSet(const SetQuery& query) {
+    std::string name = query.name;
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    
+    if (name == "query_memory_limit") {
+        TypedValue value = ColumnTypes::convert(query.value, ColumnType::INT64);
+        if (!value.valid || value.intValue < 0) {
+            throw std::runtime_error("Invalid value '" + query.value + "' for " + name);
+        }
+        config.query_memory_limit = static_cast<size_t>(value.intValue);
+    } else if (name == "durability") {
+        // Строки, ждущие окна, записываются с прежней гарантией
+        Durability durability = DatabaseConfig::parseDurability(query.value);
+        commitAllPendingRows();
+        config.durability = durability;
+    } else if (name == "group_commit_ms") {
+        TypedValue value = ColumnTypes::convert(query.value, ColumnType::INT64);
+        if (!value.valid || value.intValue < 0) {
+            throw std::runtime_error("Invalid value '" + query.value + "' for " + name);
+        }
+        config.group_commit_ms = static_cast<size_t>(value.intValue);
+        groupCommitWake.notify_one();
+    } else {
+        throw std::runtime_error("Unknown setting: " + query.name);
+    }
+}
+
+long long Database::executeCopy(const CopyQuery& query) {
+    if (!config.structure.count(query.tableName)) {
+        throw std::runtime_error("Unknown table: " + query.tableName);
+    }
+    return query.toFile ? copyTo(query) : copyFrom(query);
+}
+
+long long Database::copyFrom(const CopyQuery& query) {
+    std::string tablePath = openTable(query.tableName);
+    
+    std::ifstream input(query.filePath, std::ios::binary);
+    if (!input.is_open()) {
+        throw std::runtime_error("Cannot open file: " + query.filePath);
+    }
+    
+    // Блокировка таблицы
+    if (!FileManager::lockTable(tablePath, query.tableName)) {
+        throw std::runtime_error("Table " + query.tableName + " is locked");
+    }
+    
+    long long loaded = 0;
+    try {
+        commitPendingRows(query.tableName, true);
+        auto header = getTableHeader(tablePath, query.tableName);
+        if (header.empty()) {
+            throw std::runtime_error("Cannot read table structure");
+        }
         
+        // Заголовок файла: колонки данных таблицы, возможно с первичным ключом
+        // в начале (как в выгрузке COPY TO); значения PK из файла не используются
+        std::string headerLine;
+        std::getline(input, headerLine);
+        auto fileHeader = CSVBlockParser::splitLine(headerLine);
+        size_t skipLeading = !fileHeader.empty() && fileHeader[0] == header[0] ? 1 : 0;
+        if (!std::equal(fileHeader.begin() + skipLeading, fileHeader.end(), header.begin() + 1, header.end())) {
+            throw std::runtime_error("COPY header does not match columns of table " + query.tableName);
+        }
+        
+        // Снятый флаг упорядоченности сохраняется до записи строк (как в INSERT)
+        TableStats& stats = getTableStats(query.tableName);
+        if (stats.analyzed && keepPKOrder(stats, query.tableName)) {
+            saveStatistics(query.tableName);
+        }
+        
+        std::vector<std::string> columns(header.begin() + 1, header.end());
+        CSVBlockParser parser(columns, getTableTypes(query.tableName, columns), skipLeading, 1);
+        PKSequence& sequence = getPKSequence(query.tableName);
+        
+        // Последний чанк дописывается до tuples_limit, дальше пишутся целые чанки
         auto files = FileManager::getCSVFiles(tablePath);
+        std::string targetFile = files.empty() ? tablePath + "/1.csv" : files.back();
+        int targetRows = files.empty() ? config.tuples_limit : FileManager::getRowCount(targetFile);
+        int fileNumber = files.empty() ? 0 : std::stoi(std::filesystem::path(targetFile).stem().string());
         
-        for (const auto& file : files) {
-            auto rows = FileManager::readCSVFile(file);
-            std::vector<std::vector<std::string>> newRows;
+        std::string block;
+        std::vector<char> readBuffer(COPY_BLOCK_SIZE);
+        while (input) {
+            input.read(readBuffer.data(), readBuffer.size());
+            block.append(readBuffer.data(), input.gcount());
             
-            for (const auto& row : rows) {
-                std::map<std::string, std::vector<std::string>> rowData;
-                rowData[query.tableName] = row;
+            // Блок разбирается до последнего полного конца строки
+            size_t blockEnd = block.size();
+            if (input) {
+                size_t newline = block.rfind('\n');
+                if (newline == std::string::npos) {
+                    continue; // Строка длиннее блока
+                }
+                blockEnd = newline + 1;
+            }
+            
+            CSVRows rows = parser.parse(block.data(), block.data() + blockEnd);
+            block.erase(0, blockEnd);
+            if (rows.empty()) {
+                continue;
+            }
+            
+            // Диапазон первичных ключей резервируется для всего блока сразу
+            long long firstPK = sequence.allocate(static_cast<long long>(rows.size()));
+            for (size_t i = 0; i < rows.size(); ++i) {
+                rows[i][0] = std::to_string(firstPK + static_cast<long long>(i));
+            }
+            
+            size_t pos = 0;
+            while (pos < rows.size()) {
+                bool newChunk = targetRows >= config.tuples_limit;
+                if (newChunk) {
+                    targetFile = tablePath + "/" + std::to_string(++fileNumber) + ".csv";
+                    targetRows = 0;
+                }
                 
-                if (!evaluateConditions(query.conditions, rowData, tableHeaders)) {
-                    newRows.push_back(row);
+                size_t count = std::min(rows.size() - pos, static_cast<size_t>(config.tuples_limit - targetRows));
+                CSVRows slice(std::make_move_iterator(rows.begin() + pos),
+                              std::make_move_iterator(rows.begin() + pos + count));
+                if (newChunk) {
+                    FileManager::writeCSVFile(targetFile, header, slice);
+                } else {
+                    FileManager::appendToCSVFile(targetFile, slice);
                 }
+                
+                targetRows += static_cast<int>(count);
+                pos += count;
             }
             
-            // Перезапись файла
-            FileManager::writeCSVFile(file, header, newRows);
+            loaded += rows.size();
         }
         
     } catch (...) {
+        // Строки уже записанных блоков остаются в таблице
+        addLoadedRows(query.tableName, loaded);
         FileManager::unlockTable(tablePath, query.tableName);
         throw;
     }
     
+    addLoadedRows(query.tableName, loaded);
+    
     // Разблокировка таблицы
     FileManager::unlockTable(tablePath, query.tableName);
+    return loaded;
 }
 
+void Database::addLoadedRows(const std::string& tableName, long long count) {
+    if (count == 0) {
+        return;
+    }
+    TableStats& stats = getTableStats(tableName);
+    stats.rowCount += count;
+    if (stats.analyzed) {
+        stats.distinctCounts[tableName + "_pk"] = stats.rowCount;
+        dirtyStats.insert(tableName);
+    }
+}
+
+long long Database::copyTo(const CopyQuery& query) {
+    std::string tablePath = openTable(query.tableName);
+    
+    // Блокировка таблицы: параллельные INSERT, UPDATE и DELETE не разорвут выгрузку
+    if (!FileManager::lockTable(tablePath, query.tableName)) {
+        throw std::runtime_error("Table " + query.tableName + " is locked");
+    }
+    
+    long long exported = 0;
+    try {
+        commitPendingRows(query.tableName, true);
+        auto header = getTableHeader(tablePath, query.tableName);
+        
+        std::ofstream output(query.filePath, std::ios::binary | std::ios::trunc);
+        if (!output.is_open()) {
+            throw std::runtime_error("Cannot write to file: " + query.filePath);
+        }
+        
+        // Заголовок с первичным ключом; такой файл можно загрузить обратно через COPY FROM
+        for (size_t i = 0; i < header.size(); ++i) {
+            output << header[i];
+            if (i < header.size() - 1) output << ",";
+        }
+        output << "\n";
+        
+        // Содержимое чанков копируется блоками без разбора строк; строками данных
+        // считаются непустые строки после заголовка чанка (как в getRowCount)
+        std::vector<char> buffer(COPY_BLOCK_SIZE);
+        for (const auto& file : FileManager::getCSVFiles(tablePath)) {
+            std::ifstream input(file, std::ios::binary);
+            std::string chunkHeader;
+            if (!input.is_open() || !std::getline(input, chunkHeader)) {
+                continue;
+            }
+            
+            size_t lineLength = 0; // Длина текущей незавершенной строки
+            while (input) {
+                input.read(buffer.data(), buffer.size());
+                std::streamsize bytes = input.gcount();
+                const char* position = buffer.data();
+                const char* end = buffer.data() + bytes;
+                while (position < end) {
+                    auto newline = static_cast<const char*>(std::memchr(position, '\n', end - position));
+                    if (newline == nullptr) {
+                        lineLength += end - position;
+                        break;
+                    }
+                    if (lineLength + (newline - position) > 0) {
+                        exported++;
+                    }
+                    lineLength = 0;
+                    position = newline + 1;
+                }
+                output.write(buffer.data(), bytes);
+            }
+            
+            // Последняя строка чанка без перевода строки не сливается с первой строкой следующего
+            if (lineLength > 0) {
+                exported++;
+                output << "\n";
+            }
+        }
+        
+        output.close();
+        if (output.fail()) {
+            throw std::runtime_error("Cannot write to file: " + query.filePath);
+        }
+        
+    } catch (...) {
+        FileManager::unlockTable(tablePath, query.tableName);
+        throw;
+    }
+    
+    // Разблокировка таблицы
+    FileManager::unlockTable(tablePath, query.tableName);
+    return exported;
+}
+
+void Database::executeAnalyze(const AnalyzeQuery& query) {
+    std::vector<std::string> tableNames;
+    if (query.tableName.empty()) {
+        for (const auto& [tableName, columns] : config.structure) {
+            tableNames.push_back(tableName);
+        }
+    } else if (config.structure.count(query.tableName)) {
+        tableNames.push_back(query.tableName);
+    } else {
+        throw std::runtime_error("Unknown table: " + query.tableName);
+    }
+    
+    for (const auto& tableName : tableNames) {
+        std::string tablePath = openTable(tableName);
+        commitPendingRows(tableName, false);
+        auto header = getTableHeader(tablePath, tableName);
+        
+        TableStats stats = Statistics::analyze(FileManager::getCSVFiles(tablePath), header,
+                                               getTableTypes(tableName, header), config.read_ahead);
+        Statistics::save(tablePath, tableName, stats);
+        statsCache[tableName] = stats;
+        dirtyStats.erase(tableName);
+    }
+}
@@ -1,49 +1,66 @@
 #include "file_manager.h"
+#include "buffer_pool.h"
 #include <filesystem>
 #include <sstream>
 #include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <map>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace fs = std::filesystem;
 
-void FileManager::initializeDatabase(const std::string& schemaName, 
-                                     const std::map<std::string, std::vector<std::string>>& structure) {
-    // Создание директории схемы
+// Синхронизация директории фиксирует переименование или создание файла в ней
+static void syncDirectory(const std::string& path) {
+    int dirFd = ::open(path.empty() ? "." : path.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+}
+
+void FileManager::initializeDatabase(const std::string& schemaName) {
+    // Создание директории схемы; таблицы создаются при первом обращении
     fs::create_directories(schemaName);
+}
+
+void FileManager::initializeTable(const std::string& tablePath, const std::string& tableName,
+                                  const std::vector<std::string>& columns) {
+    std::string csvFile = tablePath + "/1.csv";
+    std::string pkFile = tablePath + "/" + tableName + "_pk_sequence";
     
-    for (const auto& [tableName, columns] : structure) {
-        std::string tablePath = schemaName + "/" + tableName;
-        fs::create_directories(tablePath);
-        
-        // Создание первого CSV файла с заголовком (только если не существует)
-        std::vector<std::string> header = columns;
-        header.insert(header.begin(), tableName + "_pk"); // Добавление колонки первичного ключа в начало
-        
-        std::string csvFile = tablePath + "/1.csv";
-        if (!fs::exists(csvFile)) {
-            std::ofstream file(csvFile);
-            if (file.is_open()) {
-                for (size_t i = 0; i < header.size(); ++i) {
-                    file << header[i];
-                    if (i < header.size() - 1) file << ",";
-                }
-                file << "\n";
-                file.close();
-            }
-        }
-        
-        // Инициализация файла последовательности первичных ключей (только если не существует)
-        std::string pkFile = tablePath + "/" + tableName + "_pk_sequence";
-        if (!fs::exists(pkFile)) {
-            std::ofstream pkStream(pkFile);
-            if (pkStream.is_open()) {
-                pkStream << "0";
-                pkStream.close();
+    // Уже созданная таблица проверяется одним обращением к файловой системе
+    std::error_code ec;
+    if (fs::exists(pkFile, ec)) {
+        return;
+    }
+    fs::create_directories(tablePath);
+    
+    // Создание первого CSV файла с заголовком (только если в таблице нет чанков)
+    std::vector<std::string> header = columns;
+    header.insert(header.begin(), tableName + "_pk"); // Добавление колонки первичного ключа в начало
+    
+    if (getCSVFiles(tablePath).empty()) {
+        std::ofstream file(csvFile);
+        if (file.is_open()) {
+            for (size_t i = 0; i < header.size(); ++i) {
+                file << header[i];
+                if (i < header.size() - 1) file << ",";
             }
+            file << "\n";
+            file.close();
         }
     }
+    
+    // Инициализация файла последовательности первичных ключей
+    std::ofstream pkStream(pkFile);
+    if (pkStream.is_open()) {
+        pkStream << "0";
+        pkStream.close();
+    }
 }
 
 std::string FileManager::getTablePath(const std::string& schemaName, const std::string& tableName) {
@@ -60,8 +77,8 @@ std::vector<std::string> FileManager::getCSVFiles(const std::string& tablePath)
     for (const auto& entry : fs::directory_iterator(tablePath)) {
         if (entry.is_regular_file()) {
             std::string filename = entry.path().filename().string();
-            if (filename.find(".csv") != std::string::npos && 
-                filename.find("_") == std::string::npos) { // Исключение файлов блокировки и последовательности
+            if (entry.path().extension() == ".csv" && 
+                filename.find("_") == std::string::npos) { // Исключение файлов блокировки, последовательности и временных
                 files.push_back(entry.path().string());
             }
         }
@@ -86,68 +103,124 @@ int FileManager::getNextFileNumber(const std::string& tablePath) {
     return std::stoi(numStr) + 1;
 }
 
-std::vector<std::vector<std::string>> FileManager::readCSVFile(const std::string& filepath) {
+std::vector<std::vector<std::string>> FileManager::readCSVFile(const std::string& filepath,
+                                                                const ColumnMask& columns) {
     std::vector<std::vector<std::string>> result;
-    std::ifstream file(filepath);
+    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
     
     if (!file.is_open()) {
         return result;
     }
     
-    std::string line;
-    bool isFirstLine = true;
+    std::string data(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(&data[0], data.size());
+    data.resize(static_cast<size_t>(file.gcount()));
+    file.close();
     
-    while (std::getline(file, line)) {
-        if (isFirstLine) {
-            isFirstLine = false;
-            continue; // Пропуск заголовка
-        }
-        
-        if (line.empty()) continue;
-        
-        std::vector<std::string> row;
-        std::stringstream ss(line);
-        std::string cell;
-        
-        while (std::getline(ss, cell, ',')) {
-            row.push_back(cell);
-        }
+    const char* pos = data.data();
+    const char* end = pos + data.size();
+    bool allColumns = columns.empty();
+    size_t width = 0;
+    
+    // Пропуск заголовка
+    const char* headerEnd = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+    pos = headerEnd ? headerEnd + 1 : end;
+    
+    while (pos < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+        if (!lineEnd) lineEnd = end;
         
-        if (!row.empty()) {
-            result.push_back(row);
+        if (lineEnd != pos) {
+            // Поля делятся по запятым, пустое поле в конце строки не создается;
+            // ненужные колонки пропускаются без копирования значения
+            std::vector<std::string> row;
+            row.reserve(width);
+            const char* field = pos;
+            while (field < lineEnd) {
+                const char* comma = static_cast<const char*>(std::memchr(field, ',', lineEnd - field));
+                if (!comma) comma = lineEnd;
+                size_t index = row.size();
+                row.emplace_back();
+                if (allColumns || (index < columns.size() && columns[index])) {
+                    row.back().assign(field, comma);
+                }
+                field = comma + 1;
+            }
+            width = row.size();
+            result.push_back(std::move(row));
         }
+        pos = lineEnd + 1;
     }
     
-    file.close();
     return result;
 }
 
+std::shared_ptr<const std::vector<std::vector<std::string>>> FileManager::readChunk(const std::string& filepath,
+                                                                                    const ColumnMask& columns) {
+    return BufferPool::instance().getChunk(filepath, columns);
+}
+
 void FileManager::writeCSVFile(const std::string& filepath, 
                                const std::vector<std::string>& header,
                                const std::vector<std::vector<std::string>>& rows) {
-    std::ofstream file(filepath);
-    
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot write to file: " + filepath);
+    std::vector<const std::vector<std::string>*> rowPointers;
+    rowPointers.reserve(rows.size());
+    for (const auto& row : rows) {
+        rowPointers.push_back(&row);
     }
+    writeCSVFile(filepath, header, rowPointers);
+}
+
+void FileManager::writeCSVFile(const std::string& filepath, 
+                               const std::vector<std::string>& header,
+                               const std::vector<const std::vector<std::string>*>& rows) {
+    std::string content;
     
     // Запись заголовка
     for (size_t i = 0; i < header.size(); ++i) {
-        file << header[i];
-        if (i < header.size() - 1) file << ",";
+        content += header[i];
+        if (i < header.size() - 1) content += ",";
     }
-    file << "\n";
+    content += "\n";
     
     // Запись строк
-    for (const auto& row : rows) {
-        for (size_t i = 0; i < row.size(); ++i) {
-            file << row[i];
-            if (i < row.size() - 1) file << ",";
+    for (const auto* row : rows) {
+        for (size_t i = 0; i < row->size(); ++i) {
+            content += (*row)[i];
+            if (i < row->size() - 1) content += ",";
         }
-        file << "\n";
+        content += "\n";
     }
     
-    file.close();
+    // Запись во временный файл с fsync до переименования и синхронизацией
+    // директории после него: при сбое, в том числе при отключении питания,
+    // остается либо старая, либо новая версия чанка целиком
+    std::string tempPath = filepath + ".tmp";
+    int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot write to file: " + filepath);
+    }
+    size_t written = 0;
+    while (written < content.size()) {
+        ssize_t n = ::write(fd, content.data() + written, content.size() - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        written += static_cast<size_t>(n);
+    }
+    bool synced = written == content.size() && ::fsync(fd) == 0;
+    ::close(fd);
+    if (!synced) {
+        fs::remove(tempPath);
+        throw std::runtime_error("Cannot write to file: " + filepath);
+    }
+    fs::rename(tempPath, filepath);
+    syncDirectory(fs::path(filepath).parent_path().string());
+    BufferPool::instance().invalidate(filepath);
 }
 
 void FileManager::appendToCSVFile(const std::string& filepath, 
@@ -165,6 +238,27 @@ void FileManager::appendToCSVFile(const std::string& filepath,
     file << "\n";
     
     file.close();
+    BufferPool::instance().invalidate(filepath);
+}
+
+void FileManager::appendToCSVFile(const std::string& filepath, 
+                                  const std::vector<std::vector<std::string>>& rows) {
+    std::ofstream file(filepath, std::ios::app);
+    
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot append to file: " + filepath);
+    }
+    
+    for (const auto& row : rows) {
+        for (size_t i = 0; i < row.size(); ++i) {
+            file << row[i];
+            if (i < row.size() - 1) file << ",";
+        }
+        file << "\n";
+    }
+    
+    file.close();
+    BufferPool::instance().invalidate(filepath);
 }
 
 int FileManager::getRowCount(const std::string& filepath) {
@@ -218,8 +312,12 @@ bool FileManager::isTableLocked(const std::string& tablePath, const std::string&
     return fs::exists(lockFile);
 }
 
-int FileManager::readPKSequence(const std::string& tablePath, const std::string& tableName) {
-    std::string pkFile = tablePath + "/" + tableName + "_pk_sequence";
+std::string FileManager::getPKSequencePath(const std::string& tablePath, const std::string& tableName) {
+    return tablePath + "/" + tableName + "_pk_sequence";
+}
+
+long long FileManager::readPKSequence(const std::string& tablePath, const std::string& tableName) {
+    std::string pkFile = getPKSequencePath(tablePath, tableName);
     
     if (!fs::exists(pkFile)) {
         return 0;
@@ -230,20 +328,30 @@ int FileManager::readPKSequence(const std::string& tablePath, const std::string&
         return 0;
     }
     
-    int pk;
+    long long pk = 0;
     file >> pk;
     file.close();
     
     return pk;
 }
 
-void FileManager::writePKSequence(const std::string& tablePath, const std::string& tableName, int pk) {
-    std::string pkFile = tablePath + "/" + tableName + "_pk_sequence";
+void FileManager::writePKSequence(const std::string& tablePath, const std::string& tableName, long long pk) {
+    std::string pkFile = getPKSequencePath(tablePath, tableName);
+    std::string tempFile = pkFile + ".tmp";
+    std::string value = std::to_string(pk);
     
-    std::ofstream file(pkFile);
-    if (file.is_open()) {
-        file << pk;
-        file.close();
+    // Граница должна пережить сбой: иначе после перезапуска ключи могут повториться
+    int fd = ::open(tempFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot write PK sequence of table " + tableName);
     }
+    bool written = ::write(fd, value.data(), value.size()) == static_cast<ssize_t>(value.size()) &&
+                   ::fsync(fd) == 0;
+    ::close(fd);
+    if (!written) {
+        fs::remove(tempFile);
+        throw std::runtime_error("Cannot write PK sequence of table " + tableName);
+    }
+    fs::rename(tempFile, pkFile);
+    syncDirectory(tablePath);
 }
-
@@ -1,19 +1,45 @@
 #include <iostream>
 #include <string>
-#include <algorithm>
-#include "config.h"
-#include "database.h"
-#include "sql_parser.h"
+#include "dbms.h"
 
-void printResults(const std::vector<std::vector<std::string>>& results) {
-    for (const auto& row : results) {
-        for (size_t i = 0; i < row.size(); ++i) {
-            std::cout << row[i];
-            if (i < row.size() - 1) {
-                std::cout << ",";
-            }
+// REPL поверх библиотеки: запросы выполняются через Database::execute,
+// строки SELECT печатаются по мере готовности, не накапливаясь в памяти
+static bool printRow(std::vector<std::string>& row) {
+    for (size_t i = 0; i < row.size(); ++i) {
+        std::cout << row[i];
+        if (i < row.size() - 1) {
+            std::cout << ",";
         }
-        std::cout << std::endl;
+    }
+    std::cout << "\n";
+    return true;
+}
+
+static void printStatus(const ResultSet& result) {
+    switch (result.type()) {
+        case QueryType::SELECT:
+            std::cout.flush();
+            break;
+        case QueryType::INSERT:
+            std::cout << "Row inserted successfully." << std::endl;
+            break;
+        case QueryType::DELETE:
+            std::cout << "Rows deleted successfully." << std::endl;
+            break;
+        case QueryType::UPDATE:
+            std::cout << "Rows updated successfully." << std::endl;
+            break;
+        case QueryType::COPY:
+            std::cout << result.affectedRows() << " rows copied." << std::endl;
+            break;
+        case QueryType::ANALYZE:
+            std::cout << "Statistics updated." << std::endl;
+            break;
+        case QueryType::SET:
+            std::cout << "Setting updated." << std::endl;
+            break;
+        default:
+            break;
     }
 }
 
@@ -31,46 +57,25 @@ int main() {
         std::string query;
         while (true) {
             std::cout << "> ";
-            std::getline(std::cin, query);
+            if (!std::getline(std::cin, query)) {
+                break; // Конец ввода
+            }
             
             if (query.empty()) {
                 continue;
             }
             
-            // Преобразование в верхний регистр для парсинга
-            std::string upperQuery = query;
-            std::transform(upperQuery.begin(), upperQuery.end(), upperQuery.begin(), ::toupper);
-            
             if (query == "exit" || query == "EXIT" || query == "quit" || query == "QUIT") {
                 break;
             }
             
-            QueryType type = SQLParser::parseQueryType(query);
+            if (SQLParser::parseQueryType(query) == QueryType::UNKNOWN) {
+                std::cout << "Unknown query type." << std::endl;
+                continue;
+            }
             
             try {
-                switch (type) {
-                    case QueryType::SELECT: {
-                        SelectQuery selectQuery = SQLParser::parseSelect(query);
-                        auto results = db.executeSelect(selectQuery);
-                        printResults(results);
-                        break;
-                    }
-                    case QueryType::INSERT: {
-                        InsertQuery insertQuery = SQLParser::parseInsert(query);
-                        db.executeInsert(insertQuery);
-                        std::cout << "Row inserted successfully." << std::endl;
-                        break;
-                    }
-                    case QueryType::DELETE: {
-                        DeleteQuery deleteQuery = SQLParser::parseDelete(query);
-                        db.executeDelete(deleteQuery);
-                        std::cout << "Rows deleted successfully." << std::endl;
-                        break;
-                    }
-                    default:
-                        std::cout << "Unknown query type." << std::endl;
-                        break;
-                }
+                printStatus(db.execute(query, printRow));
             } catch (const std::exception& e) {
                 std::cerr << "Error: " << e.what() << std::endl;
             }
@@ -83,4 +88,3 @@ int main() {
     
     return 0;
 }
-
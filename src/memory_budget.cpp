@@ -0,0 +1,45 @@
+#include "memory_budget.h"
+#include <algorithm>
+
+static const size_t MIN_SPILL_BYTES = 1024 * 1024;
+static const size_t SPILL_SHARE = 8; // Доля бюджета, которую оператор копит до сброса
+static const size_t MIN_SPILL_BUFFER = 4 * 1024;
+static const size_t MAX_SPILL_BUFFER = 1024 * 1024;
+
+MemoryBudget::MemoryBudget(size_t limit) : limitBytes(limit) {
+}
+
+void MemoryBudget::reserve(size_t bytes) {
+    usedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void MemoryBudget::release(size_t bytes) {
+    usedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+bool MemoryBudget::exceeded() const {
+    return limitBytes > 0 && usedBytes.load(std::memory_order_relaxed) > limitBytes;
+}
+
+size_t MemoryBudget::used() const {
+    return usedBytes.load(std::memory_order_relaxed);
+}
+
+size_t MemoryBudget::limit() const {
+    return limitBytes;
+}
+
+bool MemoryBudget::shouldSpill(size_t ownBytes) const {
+    return exceeded() && ownBytes >= minimumSpill();
+}
+
+size_t MemoryBudget::minimumSpill() const {
+    return std::max(MIN_SPILL_BYTES, limitBytes / SPILL_SHARE);
+}
+
+size_t MemoryBudget::spillBufferSize() const {
+    if (limitBytes == 0) {
+        return MAX_SPILL_BUFFER;
+    }
+    return std::clamp(limitBytes / MAX_MERGE_FANIN, MIN_SPILL_BUFFER, MAX_SPILL_BUFFER);
+}
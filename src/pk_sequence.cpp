@@ -0,0 +1,73 @@
+#include "pk_sequence.h"
+#include "file_manager.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+PKSequence::PKSequence(std::string tablePath, std::string tableName, long long cacheSize)
+    : tablePath(std::move(tablePath)), tableName(std::move(tableName)), cacheSize(std::max(1LL, cacheSize)) {
+    path = FileManager::getPKSequencePath(this->tablePath, this->tableName);
+    // Ключи до записанной границы могли быть выданы до перезапуска
+    limit = watchFile();
+    next = limit + 1;
+}
+
+PKSequence::~PKSequence() {
+    if (watchedFd >= 0) {
+        ::close(watchedFd);
+    }
+}
+
+long long PKSequence::watchFile() {
+    if (watchedFd >= 0) {
+        ::close(watchedFd);
+    }
+    watchedFd = ::open(path.c_str(), O_RDONLY);
+    if (watchedFd < 0) {
+        return 0;
+    }
+
+    char buffer[32];
+    ssize_t n = ::pread(watchedFd, buffer, sizeof(buffer) - 1, 0);
+    if (n <= 0) {
+        return 0;
+    }
+    buffer[n] = '\0';
+    return std::strtoll(buffer, nullptr, 10);
+}
+
+bool PKSequence::fileReplaced() const {
+    struct stat onDisk, watched;
+    if (::stat(path.c_str(), &onDisk) != 0) {
+        return false; // Файла нет - ключи еще не резервировались
+    }
+    return watchedFd < 0 || ::fstat(watchedFd, &watched) != 0 ||
+           onDisk.st_ino != watched.st_ino || onDisk.st_dev != watched.st_dev;
+}
+
+long long PKSequence::allocate(long long count) {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    // Граница в файле выше нашей - после нашего блока ключи выдавал другой процесс,
+    // и его строки уже записаны; ключи нашего блока оказались бы меньше их
+    if (fileReplaced()) {
+        long long highWaterMark = watchFile();
+        if (highWaterMark > limit) {
+            limit = highWaterMark;
+            next = highWaterMark + 1;
+        }
+    }
+
+    long long start = next;
+    long long end = start + count - 1;
+    if (end > limit) {
+        long long newLimit = end + cacheSize;
+        FileManager::writePKSequence(tablePath, tableName, newLimit);
+        limit = newLimit;
+        watchFile();
+    }
+    next = end + 1;
+    return start;
+}
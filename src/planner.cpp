@@ -0,0 +1,272 @@
+#include "planner.h"
+#include <algorithm>
+#include <limits>
+
+// Построение хэш-таблицы дороже просмотра строки при сканировании
+static const double BUILD_COST_FACTOR = 2.0;
+static const double DEFAULT_EQ_SELECTIVITY = 0.1;
+static const double RANGE_SELECTIVITY = 1.0 / 3.0;
+static const double BETWEEN_SELECTIVITY = 0.25;
+
+double Planner::distinctValues(const ColumnRef& ref,
+                               const std::vector<std::vector<std::string>>& headers,
+                               const std::vector<TableStats>& stats) {
+    if (ref.table < 0 || ref.column < 0) {
+        return -1;
+    }
+    return static_cast<double>(stats[ref.table].distinct(headers[ref.table][ref.column]));
+}
+
+void Planner::estimate(Predicate& node,
+                       const std::vector<std::vector<std::string>>& headers,
+                       const std::vector<TableStats>& stats) {
+    if (node.kind == Predicate::Kind::CONDITION) {
+        // Сравнение строк дешевле разбора типизированных значений
+        node.cost = node.type == ColumnType::STRING ? 1.0 : 2.0;
+        if (!node.condition.isLiteral) {
+            node.cost += 1.0;
+        }
+
+        double eqSelectivity = DEFAULT_EQ_SELECTIVITY;
+        if (node.condition.isLiteral) {
+            double distinct = distinctValues(node.left, headers, stats);
+            if (distinct > 0) {
+                eqSelectivity = 1.0 / distinct;
+            }
+        } else if (node.isEquiJoin()) {
+            // Соединение по ключу: 1 / max(различных значений) или 1 / max(строк)
+            double leftDistinct = distinctValues(node.left, headers, stats);
+            double rightDistinct = distinctValues(node.right, headers, stats);
+            if (leftDistinct <= 0 || rightDistinct <= 0) {
+                leftDistinct = static_cast<double>(stats[node.left.table].rowCount);
+                rightDistinct = static_cast<double>(stats[node.right.table].rowCount);
+            }
+            eqSelectivity = 1.0 / std::max(1.0, std::max(leftDistinct, rightDistinct));
+        }
+
+        switch (node.op) {
+            case CompareOp::EQ: node.selectivity = eqSelectivity; break;
+            case CompareOp::NE: node.selectivity = 1.0 - eqSelectivity; break;
+            case CompareOp::BETWEEN: node.selectivity = BETWEEN_SELECTIVITY; break;
+            default: node.selectivity = RANGE_SELECTIVITY; break;
+        }
+        return;
+    }
+
+    for (auto& child : node.children) {
+        estimate(child, headers, stats);
+    }
+
+    // AND: первыми - дешевые и отсекающие больше строк условия (cost / (1 - s)),
+    // OR: первыми - дешевые и чаще истинные (cost / s)
+    bool isAnd = node.kind == Predicate::Kind::AND;
+    auto rank = [isAnd](const Predicate& p) {
+        double passRate = isAnd ? 1.0 - p.selectivity : p.selectivity;
+        return passRate > 0 ? p.cost / passRate : std::numeric_limits<double>::infinity();
+    };
+    std::stable_sort(node.children.begin(), node.children.end(),
+                     [&](const Predicate& a, const Predicate& b) { return rank(a) < rank(b); });
+
+    // Стоимость с учетом сокращенного вычисления
+    double reach = 1.0;
+    double miss = 1.0;
+    node.cost = 0.0;
+    for (const auto& child : node.children) {
+        node.cost += reach * child.cost;
+        if (isAnd) {
+            reach *= child.selectivity;
+        } else {
+            miss *= 1.0 - child.selectivity;
+            reach = miss;
+        }
+    }
+    node.selectivity = isAnd ? reach : 1.0 - miss;
+}
+
+bool Planner::isOrdered(const ColumnRef& ref, ColumnType keyType,
+                        const std::vector<std::vector<std::string>>& headers,
+                        const std::vector<std::vector<ColumnType>>& types,
+                        const std::vector<TableStats>& stats) {
+    if (ref.table < 0 || ref.column < 0 || types[ref.table][ref.column] != keyType) {
+        return false;
+    }
+    // Упорядоченность подтверждается только ANALYZE (в том числе для первичного ключа:
+    // данные могли быть записаны до того, как выдача ключей стала монотонной)
+    return stats[ref.table].isSorted(headers[ref.table][ref.column]);
+}
+
+void Planner::addChild(Predicate& target, Predicate child) {
+    if (child.kind == Predicate::Kind::AND) {
+        for (auto& grandChild : child.children) {
+            target.children.push_back(std::move(grandChild));
+        }
+    } else {
+        target.children.push_back(std::move(child));
+    }
+}
+
+QueryPlan Planner::plan(const Predicate& where,
+                        const std::vector<std::vector<std::string>>& headers,
+                        const std::vector<std::vector<ColumnType>>& types,
+                        const std::vector<TableStats>& stats,
+                        int preferredOuter) {
+    size_t tableCount = headers.size();
+
+    // Разнесение условий: по одной таблице - в сканирование, по нескольким - в соединение
+    std::vector<Predicate> scanFilters(tableCount);
+    std::vector<Predicate> joinConditions;
+    std::vector<Predicate> constantConditions;
+
+    std::vector<Predicate> parts;
+    if (where.kind == Predicate::Kind::AND) {
+        parts = where.children;
+    } else {
+        parts.push_back(where);
+    }
+
+    for (auto& part : parts) {
+        uint64_t mask = part.tableMask();
+        if (mask == 0) {
+            constantConditions.push_back(std::move(part));
+        } else if ((mask & (mask - 1)) == 0) {
+            int table = 0;
+            while (!(mask & (uint64_t(1) << table))) table++;
+            addChild(scanFilters[table], std::move(part));
+        } else {
+            estimate(part, headers, stats);
+            joinConditions.push_back(std::move(part));
+        }
+    }
+
+    // Самые селективные соединения - первые кандидаты в хэш-ключи
+    std::stable_sort(joinConditions.begin(), joinConditions.end(),
+                     [](const Predicate& a, const Predicate& b) { return a.selectivity < b.selectivity; });
+
+    // Равенство колонок таблиц outer и inner, по которому обе упорядочены
+    auto isMergeKey = [&](const Predicate& cond, int outer, int inner) {
+        if (!cond.isEquiJoin() || cond.tableMask() != ((uint64_t(1) << outer) | (uint64_t(1) << inner))) {
+            return false;
+        }
+        return isOrdered(cond.left, cond.type, headers, types, stats) &&
+               isOrdered(cond.right, cond.type, headers, types, stats);
+    };
+    
+    std::vector<double> cardinality(tableCount);
+    for (size_t t = 0; t < tableCount; ++t) {
+        estimate(scanFilters[t], headers, stats);
+        cardinality[t] = std::max(1.0, static_cast<double>(stats[t].rowCount) * scanFilters[t].selectivity);
+    }
+
+    // Жадный выбор порядка соединения для каждой стартовой таблицы,
+    // стоимость - сумма промежуточных результатов и построенных хэш-таблиц
+    // (вторая таблица при соединении слиянием хэш-таблицы не требует)
+    std::vector<int> bestOrder;
+    double bestCost = std::numeric_limits<double>::infinity();
+
+    for (size_t start = 0; start < tableCount; ++start) {
+        if (preferredOuter >= 0 && static_cast<int>(start) != preferredOuter) {
+            continue;
+        }
+
+        std::vector<int> order{static_cast<int>(start)};
+        uint64_t placed = uint64_t(1) << start;
+        double rows = cardinality[start];
+        double cost = rows;
+
+        while (order.size() < tableCount) {
+            int next = -1;
+            double nextRows = std::numeric_limits<double>::infinity();
+
+            for (size_t t = 0; t < tableCount; ++t) {
+                if (placed & (uint64_t(1) << t)) continue;
+
+                double selectivity = 1.0;
+                for (const auto& cond : joinConditions) {
+                    if (!cond.isEquiJoin()) continue;
+                    uint64_t mask = cond.tableMask();
+                    if ((mask & (uint64_t(1) << t)) && (mask & placed)) {
+                        selectivity = std::min(selectivity, cond.selectivity);
+                    }
+                }
+
+                double estimated = rows * cardinality[t] * selectivity;
+                if (estimated < nextRows) {
+                    next = static_cast<int>(t);
+                    nextRows = estimated;
+                }
+            }
+
+            bool merge = false;
+            if (order.size() == 1) {
+                for (const auto& cond : joinConditions) {
+                    merge = merge || isMergeKey(cond, order[0], next);
+                }
+            }
+            cost += nextRows + (merge ? cardinality[next] : BUILD_COST_FACTOR * cardinality[next]);
+            rows = std::max(1.0, nextRows);
+            order.push_back(next);
+            placed |= uint64_t(1) << next;
+        }
+
+        if (cost < bestCost) {
+            bestCost = cost;
+            bestOrder = order;
+        }
+    }
+
+    QueryPlan plan;
+    std::vector<uint64_t> boundMask;
+    uint64_t bound = 0;
+    for (int table : bestOrder) {
+        PlanLevel level;
+        level.table = table;
+        level.scanFilter = std::move(scanFilters[table]);
+        level.estimatedRows = cardinality[table];
+        plan.levels.push_back(std::move(level));
+
+        bound |= uint64_t(1) << table;
+        boundMask.push_back(bound);
+    }
+
+    // Соединение слиянием: ключом второго уровня становится упорядоченное равенство
+    if (plan.levels.size() > 1) {
+        auto it = std::find_if(joinConditions.begin(), joinConditions.end(), [&](const Predicate& cond) {
+            return isMergeKey(cond, plan.levels[0].table, plan.levels[1].table);
+        });
+        if (it != joinConditions.end()) {
+            PlanLevel& level = plan.levels[1];
+            bool leftIsBuild = it->left.table == level.table;
+            level.buildKey = leftIsBuild ? it->left : it->right;
+            level.probeKey = leftIsBuild ? it->right : it->left;
+            level.keyType = it->type;
+            level.mergeJoin = true;
+            joinConditions.erase(it);
+        }
+    }
+    
+    // Условие по нескольким таблицам вычисляется на первом уровне, где все они выбраны
+    for (auto& cond : joinConditions) {
+        uint64_t mask = cond.tableMask();
+        size_t k = 0;
+        while ((boundMask[k] & mask) != mask) k++;
+
+        PlanLevel& level = plan.levels[k];
+        if (k > 0 && cond.isEquiJoin() && level.probeKey.table < 0) {
+            bool leftIsBuild = cond.left.table == level.table;
+            level.buildKey = leftIsBuild ? cond.left : cond.right;
+            level.probeKey = leftIsBuild ? cond.right : cond.left;
+            level.keyType = cond.type;
+        } else {
+            addChild(level.joinFilter, std::move(cond));
+        }
+    }
+
+    for (auto& cond : constantConditions) {
+        addChild(plan.levels[0].joinFilter, std::move(cond));
+    }
+    for (auto& level : plan.levels) {
+        estimate(level.joinFilter, headers, stats);
+    }
+
+    return plan;
+}
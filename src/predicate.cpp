@@ -0,0 +1,149 @@
+#include "predicate.h"
+#include <algorithm>
+
+static const std::string emptyValue;
+
+const std::string& tupleValue(const Tuple& tuple, const ColumnRef& ref) {
+    if (ref.table < 0 || ref.column < 0 || tuple[ref.table] == nullptr) {
+        return emptyValue;
+    }
+    const auto& row = *tuple[ref.table];
+    if (static_cast<size_t>(ref.column) >= row.size()) {
+        return emptyValue;
+    }
+    return row[ref.column];
+}
+
+Predicate Predicate::leaf(const Condition& condition) {
+    Predicate node;
+    node.kind = Kind::CONDITION;
+    node.condition = condition;
+    node.op = ColumnTypes::parseOperator(condition.operator_);
+    return node;
+}
+
+Predicate Predicate::fromConditions(const std::vector<Condition>& conditions) {
+    Predicate root;
+    if (conditions.empty()) {
+        return root;
+    }
+
+    root = leaf(conditions[0]);
+    for (size_t i = 1; i < conditions.size(); ++i) {
+        const std::string& op = conditions[i - 1].logicalOp;
+        Kind kind;
+        if (op == "AND") {
+            kind = Kind::AND;
+        } else if (op == "OR") {
+            kind = Kind::OR;
+        } else {
+            continue; // Условие без связки не учитывается
+        }
+
+        if (root.kind != kind) {
+            Predicate node;
+            node.kind = kind;
+            node.children.push_back(std::move(root));
+            root = std::move(node);
+        }
+        root.children.push_back(leaf(conditions[i]));
+    }
+
+    return root;
+}
+
+bool Predicate::isTrue() const {
+    return kind == Kind::AND && children.empty();
+}
+
+bool Predicate::isEquiJoin() const {
+    return kind == Kind::CONDITION && !condition.isLiteral && op == CompareOp::EQ &&
+           left.table >= 0 && right.table >= 0 && left.table != right.table;
+}
+
+uint64_t Predicate::tableMask() const {
+    if (kind != Kind::CONDITION) {
+        uint64_t mask = 0;
+        for (const auto& child : children) {
+            mask |= child.tableMask();
+        }
+        return mask;
+    }
+
+    uint64_t mask = 0;
+    if (left.table >= 0) {
+        mask |= uint64_t(1) << left.table;
+    }
+    if (!condition.isLiteral && right.table >= 0) {
+        mask |= uint64_t(1) << right.table;
+    }
+    return mask;
+}
+
+ColumnRef resolveColumn(const std::string& tableName, const std::string& columnName,
+                        const std::vector<std::string>& tables,
+                        const std::vector<std::vector<std::string>>& headers) {
+    ColumnRef ref;
+    auto tableIt = std::find(tables.begin(), tables.end(), tableName);
+    if (tableIt == tables.end()) {
+        return ref;
+    }
+
+    ref.table = static_cast<int>(std::distance(tables.begin(), tableIt));
+    const auto& header = headers[ref.table];
+    auto colIt = std::find(header.begin(), header.end(), columnName);
+    if (colIt != header.end()) {
+        ref.column = static_cast<int>(std::distance(header.begin(), colIt));
+    }
+    return ref;
+}
+
+void Predicate::bind(const std::vector<std::string>& tables,
+                     const std::vector<std::vector<std::string>>& headers,
+                     const std::vector<std::vector<ColumnType>>& types) {
+    for (auto& child : children) {
+        child.bind(tables, headers, types);
+    }
+    if (kind != Kind::CONDITION) {
+        return;
+    }
+
+    left = resolveColumn(condition.leftTable, condition.leftColumn, tables, headers);
+    if (!condition.isLiteral) {
+        right = resolveColumn(condition.rightTable, condition.rightColumn, tables, headers);
+    }
+    // Сравнение выполняется в типе левой колонки
+    type = left.column >= 0 ? types[left.table][left.column] : ColumnType::STRING;
+}
+
+bool Predicate::evaluateLeaf(const std::string& leftValue, const std::string& rightValue) const {
+    if (op == CompareOp::EQ && type == ColumnType::STRING) {
+        return leftValue == rightValue;
+    }
+    return ColumnTypes::evaluate(op, ColumnTypes::convert(leftValue, type),
+                                 ColumnTypes::convert(rightValue, type),
+                                 ColumnTypes::convert(condition.rightValue2, type), type);
+}
+
+bool Predicate::evaluate(const Tuple& tuple) const {
+    switch (kind) {
+        case Kind::CONDITION:
+            return evaluateLeaf(tupleValue(tuple, left),
+                                condition.isLiteral ? condition.rightValue : tupleValue(tuple, right));
+        case Kind::AND:
+            for (const auto& child : children) {
+                if (!child.evaluate(tuple)) {
+                    return false;
+                }
+            }
+            return true;
+        case Kind::OR:
+            for (const auto& child : children) {
+                if (child.evaluate(tuple)) {
+                    return true;
+                }
+            }
+            return false;
+    }
+    return false;
+}
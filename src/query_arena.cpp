@@ -0,0 +1,24 @@
+#include "query_arena.h"
+#include <cstring>
+
+// Первый блок арены; следующие блоки растут геометрически
+static const size_t INITIAL_BLOCK_SIZE = 64 * 1024;
+
+QueryArena::QueryArena() : memory(INITIAL_BLOCK_SIZE), strings(&memory) {
+}
+
+std::pmr::memory_resource* QueryArena::resource() {
+    return &memory;
+}
+
+std::string_view QueryArena::intern(std::string_view value) {
+    auto it = strings.find(value);
+    if (it != strings.end()) {
+        return *it;
+    }
+
+    char* data = static_cast<char*>(memory.allocate(value.size() + 1, alignof(char)));
+    std::memcpy(data, value.data(), value.size());
+    data[value.size()] = '\0';
+    return *strings.emplace(data, value.size()).first;
+}
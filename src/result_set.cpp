@@ -0,0 +1,60 @@
+#include "result_set.h"
+#include <algorithm>
+#include <stdexcept>
+
+ResultSet::ResultSet(QueryType type, long long affectedRows) : queryType(type), affected(affectedRows) {
+}
+
+ResultSet::ResultSet(std::vector<std::string> columnNames, std::vector<ColumnType> columnTypes, ResultRows rows)
+    : queryType(QueryType::SELECT), affected(static_cast<long long>(rows.size())),
+      names(std::move(columnNames)), types(std::move(columnTypes)), rows(std::move(rows)) {
+}
+
+ResultSet::ResultSet(std::vector<std::string> columnNames, std::vector<ColumnType> columnTypes, long long streamedRows)
+    : queryType(QueryType::SELECT), affected(streamedRows),
+      names(std::move(columnNames)), types(std::move(columnTypes)) {
+}
+
+int ResultSet::findColumn(const std::string& name) const {
+    auto it = std::find(names.begin(), names.end(), name);
+    return it == names.end() ? -1 : static_cast<int>(std::distance(names.begin(), it));
+}
+
+size_t ResultSet::batchCount(size_t batchSize) const {
+    return batchSize == 0 ? 0 : (rows.size() + batchSize - 1) / batchSize;
+}
+
+RowBatch ResultSet::batch(size_t index, size_t batchSize) const {
+    size_t start = std::min(index * batchSize, rows.size());
+    return RowBatch(rows, start, std::min(batchSize, rows.size() - start));
+}
+
+bool ResultSet::isNull(size_t row, size_t column) const {
+    return rows[row][column].empty();
+}
+
+std::string_view ResultSet::getString(size_t row, size_t column) const {
+    return rows[row][column];
+}
+
+TypedValue ResultSet::typedValue(size_t row, size_t column, ColumnType type) const {
+    const std::string& value = rows[row][column];
+    TypedValue typed = ColumnTypes::convert(value, type);
+    if (value.empty() || !typed.valid) {
+        throw std::runtime_error("Value '" + value + "' of column " + names[column] +
+                                 " is not a valid " + ColumnTypes::typeName(type));
+    }
+    return typed;
+}
+
+int64_t ResultSet::getInt64(size_t row, size_t column) const {
+    return typedValue(row, column, ColumnType::INT64).intValue;
+}
+
+double ResultSet::getDouble(size_t row, size_t column) const {
+    return typedValue(row, column, ColumnType::DOUBLE).doubleValue;
+}
+
+int64_t ResultSet::getDate(size_t row, size_t column) const {
+    return typedValue(row, column, ColumnType::DATE).intValue;
+}
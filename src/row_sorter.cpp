@@ -0,0 +1,194 @@
+#include "row_sorter.h"
+#include "buffer_pool.h"
+#include <algorithm>
+
+RowSorter::RowSorter(const std::vector<SortKey>& keys, long long limit, MemoryBudget* budget)
+    : keys(keys), limit(limit), budget(budget) {
+}
+
+RowSorter::~RowSorter() {
+    if (budget != nullptr) {
+        budget->release(reservedBytes);
+    }
+}
+
+bool RowSorter::less(const Entry& a, const Entry& b) const {
+    for (const auto& key : keys) {
+        int cmp = ColumnTypes::compare(a.row[key.index], b.row[key.index], key.type);
+        if (cmp != 0) {
+            return key.descending ? cmp > 0 : cmp < 0;
+        }
+    }
+    return a.sequence < b.sequence;
+}
+
+void RowSorter::add(std::vector<std::string> row) {
+    Entry entry{std::move(row), nextSequence++};
+    auto comparator = [this](const Entry& a, const Entry& b) { return less(a, b); };
+
+    if (limit < 0) {
+        if (budget != nullptr) {
+            size_t bytes = BufferPool::estimateRowBytes(entry.row) + sizeof(Entry);
+            budget->reserve(bytes);
+            reservedBytes += bytes;
+        }
+        entries.push_back(std::move(entry));
+        if (budget != nullptr && budget->shouldSpill(reservedBytes)) {
+            spillRun();
+        }
+        return;
+    }
+    if (limit == 0) {
+        return;
+    }
+
+    if (entries.size() < static_cast<size_t>(limit)) {
+        entries.push_back(std::move(entry));
+        std::push_heap(entries.begin(), entries.end(), comparator);
+    } else if (less(entry, entries.front())) {
+        // Новая строка лучше худшей из сохраненных
+        std::pop_heap(entries.begin(), entries.end(), comparator);
+        entries.back() = std::move(entry);
+        std::push_heap(entries.begin(), entries.end(), comparator);
+    }
+}
+
+std::unique_ptr<SpillFile> RowSorter::newRun() const {
+    return std::make_unique<SpillFile>(budget != nullptr ? budget->spillBufferSize()
+                                                         : SpillFile::DEFAULT_BUFFER_SIZE);
+}
+
+// Сортировка накопленных строк и запись их порцией во временный файл
+void RowSorter::spillRun() {
+    std::sort(entries.begin(), entries.end(), [this](const Entry& a, const Entry& b) { return less(a, b); });
+
+    auto run = newRun();
+    for (const auto& entry : entries) {
+        run->write(entry.row);
+    }
+    run->rewind();
+    runs.push_back(std::move(run));
+    runLevels.push_back(0);
+
+    entries.clear();
+    entries.shrink_to_fit();
+    budget->release(reservedBytes);
+    reservedBytes = 0;
+
+    // MAX_MERGE_FANIN порций одного уровня в конце списка сливаются в одну
+    // порцию следующего уровня; число открытых порций растет логарифмически
+    while (true) {
+        int level = runLevels.back();
+        size_t count = 0;
+        while (count < runs.size() && runLevels[runs.size() - 1 - count] == level) {
+            count++;
+        }
+        if (count < MemoryBudget::MAX_MERGE_FANIN) {
+            break;
+        }
+        size_t first = runs.size() - count;
+        auto merged = mergeToRun(first, runs.size());
+        runs.resize(first);
+        runLevels.resize(first);
+        runs.push_back(std::move(merged));
+        runLevels.push_back(level + 1);
+    }
+}
+
+std::unique_ptr<SpillFile> RowSorter::mergeToRun(size_t first, size_t last) {
+    auto merged = newRun();
+    merge(first, last, false, [&merged](std::vector<std::string>& row) {
+        merged->write(row);
+        return true;
+    });
+    merged->rewind();
+    for (size_t run = first; run < last; ++run) {
+        runs[run].reset();
+    }
+    return merged;
+}
+
+void RowSorter::merge(size_t first, size_t last, bool withMemory, const RowConsumer& consumer) {
+    // Порядковый номер строки заменяется номером порции: порции записаны
+    // в порядке поступления строк, поэтому равные строки выдаются в исходном порядке
+    size_t memoryPos = 0;
+    auto nextEntry = [&](size_t run, Entry& entry) {
+        entry.sequence = run;
+        if (run < last) {
+            return runs[run]->read(entry.row);
+        }
+        if (memoryPos == entries.size()) {
+            return false;
+        }
+        entry.row = std::move(entries[memoryPos++].row);
+        return true;
+    };
+
+    // Куча голов порций с наименьшей строкой в вершине
+    auto greater = [this](const Entry& a, const Entry& b) { return less(b, a); };
+    std::vector<Entry> heads;
+    for (size_t run = first; run < last + (withMemory ? 1 : 0); ++run) {
+        Entry entry;
+        if (nextEntry(run, entry)) {
+            heads.push_back(std::move(entry));
+            std::push_heap(heads.begin(), heads.end(), greater);
+        }
+    }
+
+    while (!heads.empty()) {
+        std::pop_heap(heads.begin(), heads.end(), greater);
+        Entry& entry = heads.back();
+        if (!consumer(entry.row)) {
+            break;
+        }
+        if (nextEntry(entry.sequence, entry)) {
+            std::push_heap(heads.begin(), heads.end(), greater);
+        } else {
+            heads.pop_back();
+        }
+    }
+}
+
+void RowSorter::finish(const RowConsumer& consumer) {
+    auto comparator = [this](const Entry& a, const Entry& b) { return less(a, b); };
+    if (limit < 0) {
+        std::sort(entries.begin(), entries.end(), comparator);
+    } else {
+        std::sort_heap(entries.begin(), entries.end(), comparator);
+    }
+
+    if (runs.empty()) {
+        for (auto& entry : entries) {
+            if (!consumer(entry.row)) {
+                break;
+            }
+        }
+        entries.clear();
+        return;
+    }
+
+    // Проходы слияния соседних групп порций, пока вместе со строками
+    // в памяти их больше MAX_MERGE_FANIN
+    while (runs.size() + 1 > MemoryBudget::MAX_MERGE_FANIN) {
+        std::vector<std::unique_ptr<SpillFile>> merged;
+        for (size_t first = 0; first < runs.size(); first += MemoryBudget::MAX_MERGE_FANIN) {
+            size_t last = std::min(first + MemoryBudget::MAX_MERGE_FANIN, runs.size());
+            merged.push_back(last - first == 1 ? std::move(runs[first]) : mergeToRun(first, last));
+        }
+        runs = std::move(merged);
+    }
+
+    merge(0, runs.size(), true, consumer);
+    entries.clear();
+    runs.clear();
+    runLevels.clear();
+}
+
+std::vector<std::vector<std::string>> RowSorter::finish() {
+    std::vector<std::vector<std::string>> rows;
+    finish([&rows](std::vector<std::string>& row) {
+        rows.push_back(std::move(row));
+        return true;
+    });
+    return rows;
+}
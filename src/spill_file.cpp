@@ -0,0 +1,73 @@
+#include "spill_file.h"
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <stdexcept>
+#include <unistd.h>
+
+SpillFile::SpillFile(size_t bufferSize) : buffer(bufferSize) {
+    std::string path = (std::filesystem::temp_directory_path() / "dbms_spill_XXXXXX").string();
+    int fd = mkstemp(path.data());
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create spill file in " + std::filesystem::temp_directory_path().string());
+    }
+    unlink(path.c_str());
+
+    file = fdopen(fd, "w+b");
+    if (file == nullptr) {
+        close(fd);
+        throw std::runtime_error("Cannot open spill file");
+    }
+    std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+}
+
+SpillFile::~SpillFile() {
+    if (file != nullptr) {
+        std::fclose(file);
+    }
+}
+
+void SpillFile::write(const std::vector<std::string>& row) {
+    uint32_t count = static_cast<uint32_t>(row.size());
+    bool ok = std::fwrite(&count, sizeof(count), 1, file) == 1;
+    for (const auto& value : row) {
+        uint32_t length = static_cast<uint32_t>(value.size());
+        ok = ok && std::fwrite(&length, sizeof(length), 1, file) == 1;
+        ok = ok && (length == 0 || std::fwrite(value.data(), 1, length, file) == length);
+    }
+    if (!ok) {
+        throw std::runtime_error("Cannot write spill file (disk full?)");
+    }
+    rows++;
+}
+
+void SpillFile::rewind() {
+    if (std::fflush(file) != 0) {
+        throw std::runtime_error("Cannot write spill file (disk full?)");
+    }
+    std::rewind(file);
+}
+
+bool SpillFile::read(std::vector<std::string>& row) {
+    uint32_t count;
+    if (std::fread(&count, sizeof(count), 1, file) != 1) {
+        return false;
+    }
+
+    row.resize(count);
+    for (auto& value : row) {
+        uint32_t length;
+        if (std::fread(&length, sizeof(length), 1, file) != 1) {
+            throw std::runtime_error("Spill file is truncated");
+        }
+        value.resize(length);
+        if (length > 0 && std::fread(value.data(), 1, length, file) != length) {
+            throw std::runtime_error("Spill file is truncated");
+        }
+    }
+    return true;
+}
+
+size_t SpillFile::rowCount() const {
+    return rows;
+}
@@ -2,6 +2,19 @@
 #include <sstream>
 #include <algorithm>
 #include <cctype>
+#include <stdexcept>
+
+bool SelectQuery::hasAggregates() const {
+    if (!groupBy.empty()) {
+        return true;
+    }
+    for (const auto& col : columns) {
+        if (col.aggregate != AggregateFunc::NONE) {
+            return true;
+        }
+    }
+    return false;
+}
 
 QueryType SQLParser::parseQueryType(const std::string& query) {
     std::string upperQuery = query;
@@ -13,6 +26,14 @@ QueryType SQLParser::parseQueryType(const std::string& query) {
         return QueryType::INSERT;
     } else if (upperQuery.find("DELETE") == 0) {
         return QueryType::DELETE;
+    } else if (upperQuery.find("UPDATE") == 0) {
+        return QueryType::UPDATE;
+    } else if (upperQuery.find("ANALYZE") == 0) {
+        return QueryType::ANALYZE;
+    } else if (upperQuery.find("COPY") == 0) {
+        return QueryType::COPY;
+    } else if (upperQuery.find("SET ") == 0) {
+        return QueryType::SET;
     }
     
     return QueryType::UNKNOWN;
@@ -31,14 +52,26 @@ std::vector<std::string> SQLParser::tokenize(const std::string& query) {
             current += c;
         } else if (inQuotes) {
             current += c;
-        } else if (std::isspace(c) || c == ',' || c == '(' || c == ')' || c == '=') {
+        } else if (std::isspace(c) || c == ',' || c == '(' || c == ')') {
             if (!current.empty()) {
                 tokens.push_back(current);
                 current.clear();
             }
-            if (c == ',' || c == '(' || c == ')' || c == '=') {
+            if (c == ',' || c == '(' || c == ')') {
                 tokens.push_back(std::string(1, c));
             }
+        } else if (c == '=' || c == '<' || c == '>' || c == '!') {
+            // Операторы сравнения: =, !=, <>, <, <=, >, >=
+            if (!current.empty()) {
+                tokens.push_back(current);
+                current.clear();
+            }
+            std::string op(1, c);
+            if (i + 1 < query.length() && 
+                (query[i + 1] == '=' || (c == '<' && query[i + 1] == '>'))) {
+                op += query[++i];
+            }
+            tokens.push_back(op);
         } else {
             current += c;
         }
@@ -72,6 +105,68 @@ static std::string toUpper(const std::string& str) {
     return result;
 }
 
+static bool isComparisonOperator(const std::string& token) {
+    return token == "=" || token == "!=" || token == "<>" || token == "<" ||
+           token == "<=" || token == ">" || token == ">=";
+}
+
+// Литерал: строка в кавычках или число без кавычек
+static bool isLiteralToken(const std::string& token) {
+    return !token.empty() && (token[0] == '\'' || token[0] == '-' ||
+                              std::isdigit(static_cast<unsigned char>(token[0])));
+}
+
+static AggregateFunc parseAggregateFunc(const std::string& token) {
+    std::string upper = toUpper(token);
+    if (upper == "COUNT") return AggregateFunc::COUNT;
+    if (upper == "SUM") return AggregateFunc::SUM;
+    if (upper == "MIN") return AggregateFunc::MIN;
+    if (upper == "MAX") return AggregateFunc::MAX;
+    if (upper == "AVG") return AggregateFunc::AVG;
+    return AggregateFunc::NONE;
+}
+
+// Ключевые слова, завершающие список таблиц или условий
+static bool isClauseKeyword(const std::string& token) {
+    std::string upper = toUpper(token);
+    return upper == "WHERE" || upper == "GROUP" || upper == "ORDER" ||
+           upper == "LIMIT" || upper == "OFFSET";
+}
+
+bool SQLParser::parseColumnRef(const std::string& token, SelectColumn& column) {
+    size_t dotPos = token.find('.');
+    if (dotPos == std::string::npos) {
+        return false;
+    }
+    column.tableName = token.substr(0, dotPos);
+    column.columnName = token.substr(dotPos + 1);
+    return true;
+}
+
+bool SQLParser::parseSelectItem(const std::vector<std::string>& tokens, size_t& pos, SelectColumn& column) {
+    AggregateFunc func = parseAggregateFunc(tokens[pos]);
+    if (func == AggregateFunc::NONE || pos + 1 >= tokens.size() || tokens[pos + 1] != "(") {
+        return parseColumnRef(tokens[pos], column);
+    }
+    
+    // Агрегатная функция: FUNC(таблица.колонка) или COUNT(*)
+    column.aggregate = func;
+    pos += 2;
+    if (pos < tokens.size() && tokens[pos] == "*") {
+        column.isStar = true;
+    } else if (pos >= tokens.size() || !parseColumnRef(tokens[pos], column)) {
+        throw std::runtime_error("Invalid aggregate argument");
+    }
+    if (column.isStar && func != AggregateFunc::COUNT) {
+        throw std::runtime_error("Only COUNT accepts *");
+    }
+    pos++;
+    if (pos >= tokens.size() || tokens[pos] != ")") {
+        throw std::runtime_error("Expected ) after aggregate argument");
+    }
+    return true;
+}
+
 Condition SQLParser::parseCondition(const std::vector<std::string>& tokens, size_t& pos) {
     Condition cond;
     cond.logicalOp = "";
@@ -86,16 +181,30 @@ Condition SQLParser::parseCondition(const std::vector<std::string>& tokens, size
         }
     }
     
-    // Оператор (=)
-    if (pos < tokens.size() && tokens[pos] == "=") {
+    // Оператор сравнения
+    if (pos < tokens.size() && isComparisonOperator(tokens[pos])) {
         cond.operator_ = tokens[pos++];
+    } else if (pos < tokens.size() && toUpper(tokens[pos]) == "BETWEEN") {
+        // BETWEEN 'нижняя' AND 'верхняя' - только литералы
+        cond.operator_ = "BETWEEN";
+        cond.isLiteral = true;
+        pos++;
+        if (pos < tokens.size()) {
+            cond.rightValue = removeQuotes(tokens[pos++]);
+        }
+        if (pos < tokens.size() && toUpper(tokens[pos]) == "AND") {
+            pos++;
+        }
+        if (pos < tokens.size()) {
+            cond.rightValue2 = removeQuotes(tokens[pos++]);
+        }
     }
     
     // Правая сторона
-    if (pos < tokens.size()) {
+    if (cond.operator_ != "BETWEEN" && pos < tokens.size()) {
         std::string right = tokens[pos];
         
-        if (right[0] == '\'') {
+        if (isLiteralToken(right)) {
             // Литеральное значение
             cond.isLiteral = true;
             cond.rightValue = removeQuotes(right);
@@ -133,12 +242,8 @@ SelectQuery SQLParser::parseSelect(const std::string& query) {
     // Парсинг колонок
     while (pos < tokens.size() && toUpper(tokens[pos]) != "FROM") {
         if (tokens[pos] != "," && tokens[pos] != " ") {
-            std::string col = tokens[pos];
-            size_t dotPos = col.find('.');
-            if (dotPos != std::string::npos) {
-                SelectColumn selectCol;
-                selectCol.tableName = col.substr(0, dotPos);
-                selectCol.columnName = col.substr(dotPos + 1);
+            SelectColumn selectCol;
+            if (parseSelectItem(tokens, pos, selectCol)) {
                 selectQuery.columns.push_back(selectCol);
             }
         }
@@ -151,7 +256,7 @@ SelectQuery SQLParser::parseSelect(const std::string& query) {
     }
     
     // Парсинг таблиц
-    while (pos < tokens.size() && toUpper(tokens[pos]) != "WHERE") {
+    while (pos < tokens.size() && !isClauseKeyword(tokens[pos])) {
         if (tokens[pos] != "," && tokens[pos] != " ") {
             selectQuery.tables.push_back(tokens[pos]);
         }
@@ -171,6 +276,64 @@ SelectQuery SQLParser::parseSelect(const std::string& query) {
         }
     }
     
+    // Парсинг GROUP BY
+    if (pos < tokens.size() && toUpper(tokens[pos]) == "GROUP") {
+        pos++;
+        if (pos < tokens.size() && toUpper(tokens[pos]) == "BY") {
+            pos++;
+        }
+        while (pos < tokens.size() && !isClauseKeyword(tokens[pos])) {
+            SelectColumn groupCol;
+            if (tokens[pos] != "," && parseColumnRef(tokens[pos], groupCol)) {
+                selectQuery.groupBy.push_back(groupCol);
+            }
+            pos++;
+        }
+    }
+    
+    // Парсинг ORDER BY
+    if (pos < tokens.size() && toUpper(tokens[pos]) == "ORDER") {
+        pos++;
+        if (pos < tokens.size() && toUpper(tokens[pos]) == "BY") {
+            pos++;
+        }
+        while (pos < tokens.size() && !isClauseKeyword(tokens[pos])) {
+            if (tokens[pos] != ",") {
+                OrderByColumn orderCol;
+                if (!parseSelectItem(tokens, pos, orderCol.column)) {
+                    throw std::runtime_error("Invalid ORDER BY column: " + tokens[pos]);
+                }
+                if (pos + 1 < tokens.size()) {
+                    std::string direction = toUpper(tokens[pos + 1]);
+                    if (direction == "ASC" || direction == "DESC") {
+                        orderCol.descending = direction == "DESC";
+                        pos++;
+                    }
+                }
+                selectQuery.orderBy.push_back(orderCol);
+            }
+            pos++;
+        }
+    }
+    
+    // Парсинг LIMIT и OFFSET
+    while (pos < tokens.size()) {
+        std::string keyword = toUpper(tokens[pos]);
+        if ((keyword != "LIMIT" && keyword != "OFFSET") || pos + 1 >= tokens.size()) {
+            break;
+        }
+        long long value = std::stoll(tokens[pos + 1]);
+        if (value < 0) {
+            throw std::runtime_error(keyword + " must not be negative");
+        }
+        if (keyword == "LIMIT") {
+            selectQuery.limit = value;
+        } else {
+            selectQuery.offset = value;
+        }
+        pos += 2;
+    }
+    
     return selectQuery;
 }
 
@@ -243,3 +406,122 @@ DeleteQuery SQLParser::parseDelete(const std::string& query) {
     return deleteQuery;
 }
 
+
+UpdateQuery SQLParser::parseUpdate(const std::string& query) {
+    UpdateQuery updateQuery;
+    auto tokens = tokenize(query);
+    
+    size_t pos = 1; // Пропуск UPDATE
+    
+    // Получение имени таблицы
+    if (pos < tokens.size()) {
+        updateQuery.tableName = tokens[pos++];
+    }
+    
+    if (pos >= tokens.size() || toUpper(tokens[pos]) != "SET") {
+        throw std::runtime_error("Expected SET in UPDATE");
+    }
+    pos++;
+    
+    // Парсинг присваиваний: колонка = значение [, колонка = значение ...]
+    while (pos < tokens.size() && toUpper(tokens[pos]) != "WHERE") {
+        if (tokens[pos] == ",") {
+            pos++;
+            continue;
+        }
+        if (pos + 2 >= tokens.size() || tokens[pos + 1] != "=") {
+            throw std::runtime_error("Invalid assignment in UPDATE near " + tokens[pos]);
+        }
+        
+        Assignment assignment;
+        SelectColumn column;
+        if (parseColumnRef(tokens[pos], column)) {
+            if (column.tableName != updateQuery.tableName) {
+                throw std::runtime_error("Column " + tokens[pos] + " does not belong to table " +
+                                         updateQuery.tableName);
+            }
+            assignment.columnName = column.columnName;
+        } else {
+            assignment.columnName = tokens[pos];
+        }
+        assignment.value = removeQuotes(tokens[pos + 2]);
+        updateQuery.assignments.push_back(assignment);
+        pos += 3;
+    }
+    
+    if (updateQuery.assignments.empty()) {
+        throw std::runtime_error("UPDATE requires at least one assignment");
+    }
+    
+    // Парсинг условий WHERE
+    if (pos < tokens.size() && toUpper(tokens[pos]) == "WHERE") {
+        pos++;
+        while (pos < tokens.size()) {
+            Condition cond = parseCondition(tokens, pos);
+            updateQuery.conditions.push_back(cond);
+            
+            if (cond.logicalOp.empty()) {
+                break;
+            }
+        }
+    }
+    
+    return updateQuery;
+}
+
+AnalyzeQuery SQLParser::parseAnalyze(const std::string& query) {
+    AnalyzeQuery analyzeQuery;
+    auto tokens = tokenize(query);
+    
+    // ANALYZE [таблица]
+    if (tokens.size() > 1) {
+        analyzeQuery.tableName = tokens[1];
+    }
+    
+    return analyzeQuery;
+}
+
+CopyQuery SQLParser::parseCopy(const std::string& query) {
+    CopyQuery copyQuery;
+    auto tokens = tokenize(query);
+    
+    // COPY таблица FROM 'файл' | COPY таблица TO 'файл'
+    if (tokens.size() != 4) {
+        throw std::runtime_error("Expected COPY <table> FROM|TO '<file>'");
+    }
+    
+    copyQuery.tableName = tokens[1];
+    std::string direction = toUpper(tokens[2]);
+    if (direction == "TO") {
+        copyQuery.toFile = true;
+    } else if (direction != "FROM") {
+        throw std::runtime_error("Expected FROM or TO in COPY");
+    }
+    copyQuery.filePath = removeQuotes(tokens[3]);
+    
+    return copyQuery;
+}
+
+SetQuery SQLParser::parseSet(const std::string& query) {
+    SetQuery setQuery;
+    auto tokens = tokenize(query);
+    
+    // SET имя = значение | SET имя TO значение (знак = может быть без пробелов)
+    std::string assignment;
+    for (size_t i = 1; i < tokens.size(); ++i) {
+        if (toUpper(tokens[i]) == "TO" && i == 2) {
+            assignment += "=";
+        } else {
+            assignment += tokens[i];
+        }
+    }
+    
+    size_t eqPos = assignment.find('=');
+    if (eqPos == std::string::npos || eqPos == 0 || eqPos == assignment.size() - 1) {
+        throw std::runtime_error("Expected SET <name> = <value>");
+    }
+    setQuery.name = assignment.substr(0, eqPos);
+    setQuery.value = removeQuotes(assignment.substr(eqPos + 1));
+    
+    return setQuery;
+}
@@ -0,0 +1,104 @@
+#include "statistics.h"
+#include "chunk_reader.h"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_set>
+
+long long TableStats::distinct(const std::string& columnName) const {
+    auto it = distinctCounts.find(columnName);
+    if (it == distinctCounts.end()) {
+        return -1;
+    }
+    return std::max(1LL, std::min(it->second, rowCount));
+}
+
+bool TableStats::isSorted(const std::string& columnName) const {
+    return sortedColumns.count(columnName) > 0;
+}
+
+bool Statistics::load(const std::string& tablePath, const std::string& tableName, TableStats& stats) {
+    std::ifstream file(tablePath + "/" + tableName + "_stats");
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // Формат: число строк, затем строки "колонка<TAB>число различных значений[<TAB>sorted]"
+    std::string line;
+    if (!std::getline(file, line)) {
+        return false;
+    }
+    stats.rowCount = std::stoll(line);
+    stats.distinctCounts.clear();
+    stats.sortedColumns.clear();
+
+    while (std::getline(file, line)) {
+        size_t tabPos = line.find('\t');
+        if (tabPos == std::string::npos) continue;
+        std::string column = line.substr(0, tabPos);
+        size_t flagPos = line.find('\t', tabPos + 1);
+        stats.distinctCounts[column] = std::stoll(line.substr(tabPos + 1, flagPos - tabPos - 1));
+        if (flagPos != std::string::npos && line.compare(flagPos + 1, std::string::npos, "sorted") == 0) {
+            stats.sortedColumns.insert(column);
+        }
+    }
+
+    stats.analyzed = true;
+    file.close();
+    return true;
+}
+
+void Statistics::save(const std::string& tablePath, const std::string& tableName, const TableStats& stats) {
+    std::ofstream file(tablePath + "/" + tableName + "_stats");
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot write statistics for table " + tableName);
+    }
+
+    file << stats.rowCount << "\n";
+    for (const auto& [column, count] : stats.distinctCounts) {
+        file << column << "\t" << count;
+        if (stats.isSorted(column)) {
+            file << "\tsorted";
+        }
+        file << "\n";
+    }
+    file.close();
+}
+
+TableStats Statistics::analyze(const std::vector<std::string>& files, const std::vector<std::string>& header,
+                              const std::vector<ColumnType>& types, size_t readAhead) {
+    TableStats stats;
+    std::vector<std::unordered_set<std::string>> values(header.size());
+    std::vector<bool> sorted(header.size(), true);
+
+    // Упорядоченность проверяется сравнением с предыдущей строкой в типе колонки;
+    // предыдущий чанк удерживается, пока на его строку есть ссылка
+    std::shared_ptr<const CSVRows> previousChunk;
+    const std::vector<std::string>* previousRow = nullptr;
+
+    ChunkReader reader(files, readAhead);
+    std::shared_ptr<const CSVRows> rows;
+    while (reader.next(rows)) {
+        stats.rowCount += rows->size();
+        for (const auto& row : *rows) {
+            for (size_t i = 0; i < header.size() && i < row.size(); ++i) {
+                values[i].insert(row[i]);
+                if (sorted[i] && previousRow != nullptr && i < previousRow->size() &&
+                    ColumnTypes::compare((*previousRow)[i], row[i], types[i]) > 0) {
+                    sorted[i] = false;
+                }
+            }
+            previousRow = &row;
+        }
+        previousChunk = rows;
+    }
+
+    for (size_t i = 0; i < header.size(); ++i) {
+        stats.distinctCounts[header[i]] = values[i].size();
+        if (sorted[i]) {
+            stats.sortedColumns.insert(header[i]);
+        }
+    }
+    stats.analyzed = true;
+    return stats;
+}
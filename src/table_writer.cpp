@@ -0,0 +1,233 @@
+#include "table_writer.h"
+#include "file_manager.h"
+#include "buffer_pool.h"
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// Группа записывается, не дожидаясь окна, когда накопила столько байт
+static const size_t GROUP_COMMIT_BYTES = 1024 * 1024;
+
+static void writeAll(int fd, const std::string& data, const std::string& path) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("Cannot append to file: " + path);
+        }
+        written += static_cast<size_t>(n);
+    }
+}
+
+TableWriter::TableWriter(std::string tablePath, std::vector<std::string> header, int tuplesLimit)
+    : tablePath(std::move(tablePath)), header(std::move(header)), tuplesLimit(std::max(1, tuplesLimit)) {
+}
+
+TableWriter::~TableWriter() {
+    closeTail();
+}
+
+TableWriter::GroupRow TableWriter::append(const std::vector<std::string>& values) {
+    std::string line;
+    for (const auto& value : values) {
+        line += ",";
+        line += value;
+    }
+    line += "\n";
+
+    if (pending.empty()) {
+        firstPending = std::chrono::steady_clock::now();
+    }
+    pendingBytes += line.size();
+    pending.push_back(std::move(line));
+    return GroupRow{group, group->rows++};
+}
+
+bool TableWriter::due(std::chrono::milliseconds window) const {
+    if (pending.empty()) {
+        return false;
+    }
+    return pendingBytes >= GROUP_COMMIT_BYTES || std::chrono::steady_clock::now() - firstPending >= window;
+}
+
+void TableWriter::closeTail() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+bool TableWriter::tailChanged() const {
+    if (fd < 0) {
+        return true;
+    }
+
+    // Чанк заменен переименованием (UPDATE/DELETE), удален или дописан не нами
+    struct stat onDisk, opened;
+    if (::stat(tailPath.c_str(), &onDisk) != 0 || ::fstat(fd, &opened) != 0 ||
+        onDisk.st_ino != opened.st_ino || onDisk.st_dev != opened.st_dev || onDisk.st_size != tailSize) {
+        return true;
+    }
+
+    // Следующий чанк создан другим процессом или COPY
+    std::error_code ec;
+    return fs::exists(tablePath + "/" + std::to_string(tailNumber + 1) + ".csv", ec);
+}
+
+void TableWriter::openTail() {
+    closeTail();
+
+    auto files = FileManager::getCSVFiles(tablePath);
+    if (files.empty()) {
+        createChunk(1, Durability::FLUSH);
+        return;
+    }
+
+    tailPath = files.back();
+    tailNumber = std::stoi(fs::path(tailPath).stem().string());
+    tailRows = FileManager::getRowCount(tailPath);
+
+    fd = ::open(tailPath.c_str(), O_WRONLY | O_APPEND);
+    struct stat st;
+    if (fd < 0 || ::fstat(fd, &st) != 0) {
+        closeTail();
+        throw std::runtime_error("Cannot append to file: " + tailPath);
+    }
+    tailSize = st.st_size;
+
+    // Пустой чанк остался после сбоя между созданием файла и записью заголовка
+    if (tailSize == 0) {
+        std::string headerLine = formatHeader();
+        writeAll(fd, headerLine, tailPath);
+        tailSize = static_cast<off_t>(headerLine.size());
+    }
+}
+
+std::string TableWriter::formatHeader() const {
+    std::string headerLine;
+    for (size_t i = 0; i < header.size(); ++i) {
+        headerLine += header[i];
+        if (i < header.size() - 1) headerLine += ",";
+    }
+    headerLine += "\n";
+    return headerLine;
+}
+
+void TableWriter::createChunk(int number, Durability durability) {
+    closeTail();
+
+    std::string path = tablePath + "/" + std::to_string(number) + ".csv";
+
+    // Существующий чанк не перезаписывается: его мог создать другой процесс или COPY,
+    // тогда дозапись продолжается в последний чанк таблицы
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_APPEND, 0644);
+    if (fd < 0) {
+        if (errno == EEXIST) {
+            openTail();
+            return;
+        }
+        throw std::runtime_error("Cannot write to file: " + path);
+    }
+    tailPath = path;
+    tailNumber = number;
+    tailRows = 0;
+
+    std::string headerLine = formatHeader();
+    writeAll(fd, headerLine, tailPath);
+    tailSize = static_cast<off_t>(headerLine.size());
+
+    if (durability == Durability::FSYNC) {
+        // Новый чанк должен пережить сбой вместе с записью в директории
+        ::fdatasync(fd);
+        int dirFd = ::open(tablePath.c_str(), O_RDONLY | O_DIRECTORY);
+        if (dirFd >= 0) {
+            ::fsync(dirFd);
+            ::close(dirFd);
+        }
+    }
+}
+
+void TableWriter::commit(Durability durability, PKSequence& sequence) {
+    if (pending.empty()) {
+        return;
+    }
+    if (tailChanged()) {
+        openTail();
+    }
+
+    // Ключи выдаются при записи под блокировкой таблицы: строки, ждавшие группу,
+    // не получат ключи меньше записанных за это время другим процессом
+    long long nextPK = sequence.allocate(static_cast<long long>(pending.size()));
+
+    // Группа делится по чанкам с учетом tuples_limit; в каждый чанк - один write
+    size_t next = 0;
+    bool writing = false;
+    try {
+        while (next < pending.size()) {
+            if (tailRows >= tuplesLimit) {
+                createChunk(tailNumber + 1, durability);
+            }
+
+            size_t count = std::min(pending.size() - next, static_cast<size_t>(tuplesLimit - tailRows));
+            std::string block;
+            for (size_t i = next; i < next + count; ++i) {
+                block += std::to_string(nextPK + static_cast<long long>(i));
+                block += pending[i];
+            }
+
+            writing = true;
+            writeAll(fd, block, tailPath);
+            if (durability == Durability::FSYNC && ::fdatasync(fd) != 0) {
+                throw std::runtime_error("Cannot sync file: " + tailPath);
+            }
+            writing = false;
+
+            tailRows += static_cast<int>(count);
+            tailSize += static_cast<off_t>(block.size());
+            next += count;
+            BufferPool::instance().invalidate(tailPath);
+        }
+    } catch (const std::exception& e) {
+        // Часть блока могла попасть в чанк: без обрезки повтор дописал бы
+        // недописанную строку и записал бы строки блока второй раз
+        if (writing) {
+            ::ftruncate(fd, tailSize);
+            BufferPool::instance().invalidate(tailPath);
+        }
+        closeTail();
+
+        group->written += next;
+        pending.erase(pending.begin(), pending.begin() + next);
+        pendingBytes = 0;
+        for (const auto& line : pending) {
+            pendingBytes += line.size();
+        }
+        // При flush и fsync INSERT ждет группу и получает ошибку; при NONE
+        // INSERT уже завершен, и строки записываются при следующем commit
+        if (durability != Durability::NONE) {
+            abandon(e.what());
+        }
+        throw;
+    }
+
+    group->written += pending.size();
+    group->done = true;
+    group = std::make_shared<Group>();
+    pending.clear();
+    pendingBytes = 0;
+}
+
+void TableWriter::abandon(const std::string& error) {
+    group->error = error;
+    group->done = true;
+    group = std::make_shared<Group>();
+    pending.clear();
+    pendingBytes = 0;
+}
@@ -0,0 +1,158 @@
+#include "types.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+
+ColumnType ColumnTypes::parseType(const std::string& name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+    if (lower.empty() || lower == "string") {
+        return ColumnType::STRING;
+    } else if (lower == "int64") {
+        return ColumnType::INT64;
+    } else if (lower == "double") {
+        return ColumnType::DOUBLE;
+    } else if (lower == "date") {
+        return ColumnType::DATE;
+    }
+
+    throw std::runtime_error("Unknown column type: " + name);
+}
+
+std::string ColumnTypes::typeName(ColumnType type) {
+    switch (type) {
+        case ColumnType::INT64: return "int64";
+        case ColumnType::DOUBLE: return "double";
+        case ColumnType::DATE: return "date";
+        default: return "string";
+    }
+}
+
+CompareOp ColumnTypes::parseOperator(const std::string& op) {
+    if (op == "=" || op.empty()) {
+        return CompareOp::EQ;
+    } else if (op == "!=" || op == "<>") {
+        return CompareOp::NE;
+    } else if (op == "<") {
+        return CompareOp::LT;
+    } else if (op == "<=") {
+        return CompareOp::LE;
+    } else if (op == ">") {
+        return CompareOp::GT;
+    } else if (op == ">=") {
+        return CompareOp::GE;
+    } else if (op == "BETWEEN") {
+        return CompareOp::BETWEEN;
+    }
+    return CompareOp::INVALID;
+}
+
+// Дата в формате YYYY-MM-DD переводится в число YYYYMMDD
+static bool parseDate(const std::string& value, int64_t& result) {
+    if (value.size() != 10 || value[4] != '-' || value[7] != '-') {
+        return false;
+    }
+    for (size_t i : {0, 1, 2, 3, 5, 6, 8, 9}) {
+        if (!std::isdigit(static_cast<unsigned char>(value[i]))) {
+            return false;
+        }
+    }
+
+    int year = std::stoi(value.substr(0, 4));
+    int month = std::stoi(value.substr(5, 2));
+    int day = std::stoi(value.substr(8, 2));
+    if (month < 1 || month > 12 || day < 1 || day > 31) {
+        return false;
+    }
+
+    result = year * 10000 + month * 100 + day;
+    return true;
+}
+
+TypedValue ColumnTypes::convert(const std::string& value, ColumnType type) {
+    TypedValue result{false, 0, 0.0, &value};
+    const char* begin = value.data();
+    const char* end = begin + value.size();
+
+    switch (type) {
+        case ColumnType::STRING:
+            result.valid = true;
+            break;
+        case ColumnType::INT64: {
+            auto [ptr, ec] = std::from_chars(begin, end, result.intValue);
+            result.valid = !value.empty() && ec == std::errc() && ptr == end;
+            break;
+        }
+        case ColumnType::DOUBLE: {
+            auto [ptr, ec] = std::from_chars(begin, end, result.doubleValue);
+            result.valid = !value.empty() && ec == std::errc() && ptr == end;
+            break;
+        }
+        case ColumnType::DATE:
+            result.valid = parseDate(value, result.intValue);
+            break;
+    }
+
+    return result;
+}
+
+bool ColumnTypes::isValid(const std::string& value, ColumnType type) {
+    return value.empty() || convert(value, type).valid;
+}
+
+int ColumnTypes::compare(const TypedValue& a, const TypedValue& b, ColumnType type) {
+    if (!a.valid || !b.valid) {
+        if (a.valid != b.valid) {
+            return a.valid ? 1 : -1;
+        }
+        return a.text->compare(*b.text);
+    }
+
+    switch (type) {
+        case ColumnType::INT64:
+        case ColumnType::DATE:
+            return (a.intValue > b.intValue) - (a.intValue < b.intValue);
+        case ColumnType::DOUBLE:
+            return (a.doubleValue > b.doubleValue) - (a.doubleValue < b.doubleValue);
+        default:
+            return a.text->compare(*b.text);
+    }
+}
+
+int ColumnTypes::compare(const std::string& a, const std::string& b, ColumnType type) {
+    if (type == ColumnType::STRING) {
+        return a.compare(b);
+    }
+    return compare(convert(a, type), convert(b, type), type);
+}
+
+std::string ColumnTypes::formatDouble(double value) {
+    char buffer[64];
+    auto [ptr, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return std::string(buffer, ptr);
+}
+
+bool ColumnTypes::test(CompareOp op, int cmp) {
+    switch (op) {
+        case CompareOp::EQ: return cmp == 0;
+        case CompareOp::NE: return cmp != 0;
+        case CompareOp::LT: return cmp < 0;
+        case CompareOp::LE: return cmp <= 0;
+        case CompareOp::GT: return cmp > 0;
+        case CompareOp::GE: return cmp >= 0;
+        default: return false;
+    }
+}
+
+bool ColumnTypes::evaluate(CompareOp op, const TypedValue& value,
+                           const TypedValue& right, const TypedValue& upper, ColumnType type) {
+    if (!value.valid || !right.valid || (op == CompareOp::BETWEEN && !upper.valid)) {
+        return false;
+    }
+    if (op == CompareOp::BETWEEN) {
+        return compare(value, right, type) >= 0 && compare(value, upper, type) <= 0;
+    }
+    return test(op, compare(value, right, type));
+}